@@ -1,7 +1,20 @@
 #pragma once
 
+#include "checks.h"
 #include "class_wrapper.h"
 #include "jni_types.h"
+#include "ref_accounting.h"
+
+#include <algorithm>
+#include <compare>
+#include <cstddef>
+#include <iterator>
+#include <memory_resource>
+#include <ranges>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
 
 namespace jnipp::java::array_extractors {
 
@@ -15,134 +28,652 @@ inline auto get_element(::jarray, ::jsize)
 template<>
 inline auto get_element<return_type::object_>(::jarray instance, ::jsize i)
 {
-    return GetJNI()->GetObjectArrayElement(
+    auto element = GetJNI()->GetObjectArrayElement(
         reinterpret_cast<jobjectArray>(instance), i);
+
+    if constexpr(accounting::enabled)
+        accounting::local_created(element, "<array element>");
+
+    return element;
 }
 
-#define DEFINE_GET_ELEMENT(JAVA_TYPE, JAVA_NAME, RETURN_TYPE)          \
-    template<>                                                         \
-    inline auto get_element<RETURN_TYPE>(::jarray instance, ::jsize i) \
-    {                                                                  \
-        JAVA_TYPE out;                                                 \
-        GetJNI()->Get##JAVA_NAME##ArrayRegion(                         \
-            reinterpret_cast<JAVA_TYPE##Array>(instance), i, 1, &out); \
-        return out;                                                    \
+template<return_type T>
+struct element_type
+{
+    using type       = ::jobject;
+    using array_type = ::jobjectArray;
+};
+
+#define DEFINE_ARRAY_ACCESS(JAVA_TYPE, JAVA_NAME, RETURN_TYPE)                 \
+    template<>                                                                 \
+    struct element_type<RETURN_TYPE>                                           \
+    {                                                                          \
+        using type       = JAVA_TYPE;                                          \
+        using array_type = JAVA_TYPE##Array;                                   \
+    };                                                                         \
+    template<>                                                                 \
+    inline auto get_element<RETURN_TYPE>(::jarray instance, ::jsize i)         \
+    {                                                                          \
+        JAVA_TYPE out;                                                         \
+        GetJNI()->Get##JAVA_NAME##ArrayRegion(                                 \
+            reinterpret_cast<JAVA_TYPE##Array>(instance), i, 1, &out);         \
+        return out;                                                            \
+    }                                                                          \
+    inline void get_region(                                                    \
+        JAVA_TYPE##Array instance, ::jsize i, ::jsize n, JAVA_TYPE* out)       \
+    {                                                                          \
+        GetJNI()->Get##JAVA_NAME##ArrayRegion(instance, i, n, out);            \
+    }                                                                          \
+    inline void set_region(                                                    \
+        JAVA_TYPE##Array instance, ::jsize i, ::jsize n, JAVA_TYPE const* in)  \
+    {                                                                          \
+        GetJNI()->Set##JAVA_NAME##ArrayRegion(instance, i, n, in);             \
+    }                                                                          \
+    inline JAVA_TYPE* get_elements(JAVA_TYPE##Array instance, jboolean* copy)  \
+    {                                                                          \
+        return GetJNI()->Get##JAVA_NAME##ArrayElements(instance, copy);        \
+    }                                                                          \
+    inline void release_elements(                                              \
+        JAVA_TYPE##Array instance, JAVA_TYPE* elements, jint mode)             \
+    {                                                                          \
+        GetJNI()->Release##JAVA_NAME##ArrayElements(instance, elements, mode); \
     }
 
-DEFINE_GET_ELEMENT(::jboolean, Boolean, return_type::bool_)
-DEFINE_GET_ELEMENT(::jbyte, Byte, return_type::byte_)
-DEFINE_GET_ELEMENT(::jchar, Char, return_type::char_)
-DEFINE_GET_ELEMENT(::jshort, Short, return_type::short_)
-DEFINE_GET_ELEMENT(::jint, Int, return_type::int_)
-DEFINE_GET_ELEMENT(::jlong, Long, return_type::long_)
-DEFINE_GET_ELEMENT(::jfloat, Float, return_type::float_)
-DEFINE_GET_ELEMENT(::jdouble, Double, return_type::double_)
+DEFINE_ARRAY_ACCESS(::jboolean, Boolean, return_type::bool_)
+DEFINE_ARRAY_ACCESS(::jbyte, Byte, return_type::byte_)
+DEFINE_ARRAY_ACCESS(::jchar, Char, return_type::char_)
+DEFINE_ARRAY_ACCESS(::jshort, Short, return_type::short_)
+DEFINE_ARRAY_ACCESS(::jint, Int, return_type::int_)
+DEFINE_ARRAY_ACCESS(::jlong, Long, return_type::long_)
+DEFINE_ARRAY_ACCESS(::jfloat, Float, return_type::float_)
+DEFINE_ARRAY_ACCESS(::jdouble, Double, return_type::double_)
 
-#undef DEFINE_GET_ELEMENT
+#undef DEFINE_ARRAY_ACCESS
 
 } // namespace detail
 
+template<return_type T>
+struct element_ref;
+
 template<return_type T>
 struct extract_type
 {
+    using value_type = typename detail::element_type<T>::type;
+    using array_type = typename detail::element_type<T>::array_type;
+
     extract_type(java::array array)
         : ref(array)
     {
     }
 
+    /*!
+     * \param array
+     * \param length length of the array, if already known
+     */
+    extract_type(java::array array, jsize length)
+        : ref(array)
+        , m_length(length)
+    {
+    }
+
+    /*!
+     * \brief Length of the array, which is fetched once
+     * \return
+     */
     jlong length() const
     {
-        return ref.length();
+        if(m_length < 0)
+            m_length = static_cast<jsize>(ref.length());
+        return m_length;
     }
 
     auto operator[](jsize index)
     {
-        if(index >= length())
-            throw std::out_of_range(
-                std::to_string(index) + " >= " + std::to_string(length()));
+        if constexpr(checks::bounds)
+            check_index(index);
 
         if constexpr(T == return_type::object_)
-            return wrapping::jobject(java::object{
-                ref.value_class,
-                GetJNI()->GetObjectArrayElement(
-                    reinterpret_cast<jobjectArray>(ref.instance), index),
-            });
-        else if constexpr(T != return_type::object_)
-            return detail::get_element<T>(ref.instance, index);
+        {
+            auto element = detail::get_element<T>(ref.instance, index);
+            invocation::call::check_exception();
+
+            return wrapping::jobject(java::object{ref.value_class, element});
+        } else
+        {
+            auto element = detail::get_element<T>(ref.instance, index);
+            invocation::call::check_exception();
+
+            return element;
+        }
+    }
+
+    /*!
+     * \brief Get a reference to an element, which can be assigned to
+     * \param index
+     * \return
+     */
+    element_ref<T> at(jsize index)
+    {
+        return {*this, index};
+    }
+
+    /*!
+     * \brief Write a single element
+     * \param index
+     * \param value
+     */
+    void set(jsize index, value_type value)
+    {
+        if constexpr(checks::bounds)
+            check_index(index);
+
+        if constexpr(T == return_type::object_)
+            GetJNI()->SetObjectArrayElement(array(), index, value);
         else
-            return java::value();
+            detail::set_region(array(), index, 1, &value);
+
+        invocation::call::check_exception();
+    }
+
+    /*!
+     * \brief Copy elements out of the array, starting at offset
+     * \param out
+     * \param offset
+     */
+    void read(std::span<value_type> out, jsize offset = 0)
+    {
+        detail::get_region(
+            array(), offset, static_cast<jsize>(out.size()), out.data());
+        invocation::call::check_exception();
+    }
+
+    template<std::ranges::contiguous_range Range>
+    requires std::is_same_v<std::ranges::range_value_t<Range>, value_type>
+    /*!
+     * \brief Write a contiguous range of values back to the array with a
+     * single Set<Type>ArrayRegion
+     * \param values
+     * \param offset first element of the array to write to
+     */
+    void write(Range const& values, jsize offset = 0)
+    {
+        detail::set_region(
+            array(),
+            offset,
+            static_cast<jsize>(std::ranges::size(values)),
+            std::ranges::data(values));
+        invocation::call::check_exception();
+    }
+
+    array_type array() const
+    {
+        return reinterpret_cast<array_type>(ref.instance);
     }
 
     java::array ref;
+
+  private:
+    void check_index(jsize index) const
+    {
+        if(index < 0 || index >= length())
+            throw std::out_of_range(
+                "index " + std::to_string(index) +
+                " out of bounds for length " + std::to_string(length()));
+    }
+
+    mutable jsize m_length = -1;
+};
+
+template<return_type T>
+/*!
+ * \brief Proxy for a single array element, reading or writing it through JNI
+ */
+struct element_ref
+{
+    using value_type = typename extract_type<T>::value_type;
+
+    operator auto() const
+    {
+        return array[index];
+    }
+
+    element_ref& operator=(value_type value)
+    {
+        array.set(index, value);
+        return *this;
+    }
+
+    extract_type<T>& array;
+    jsize            index;
+};
+
+template<return_type T>
+requires(T != return_type::object_)
+/*!
+ * \brief Elements of a primitive array pinned or copied into native memory
+ * with Get<Type>ArrayElements, for editing in place. Changes are written back
+ * when this goes out of scope, unless abort() is called.
+ */
+struct pinned_elements
+{
+    using value_type = typename detail::element_type<T>::type;
+    using array_type = typename detail::element_type<T>::array_type;
+
+    pinned_elements(java::array array)
+        : m_array(reinterpret_cast<array_type>(array.instance))
+        , m_size(static_cast<size_t>(array.length()))
+    {
+        jboolean copy = JNI_FALSE;
+        m_elements    = detail::get_elements(m_array, &copy);
+        m_copy        = copy == JNI_TRUE;
+
+        /* Null with an OutOfMemoryError pending */
+        if(!m_elements)
+        {
+            invocation::call::check_exception();
+            throw std::runtime_error("failed to get array elements");
+        }
+    }
+
+    pinned_elements(pinned_elements const&) = delete;
+    pinned_elements& operator=(pinned_elements const&) = delete;
+
+    ~pinned_elements()
+    {
+        release();
+    }
+
+    /*!
+     * \brief Write changes back to the array, keeping the elements
+     * available (JNI_COMMIT). Does nothing if the elements are pinned.
+     */
+    void commit()
+    {
+        if(m_elements && m_copy)
+            detail::release_elements(m_array, m_elements, JNI_COMMIT);
+    }
+
+    /*!
+     * \brief Release the elements without writing changes back (JNI_ABORT)
+     */
+    void abort()
+    {
+        if(m_elements)
+            detail::release_elements(m_array, m_elements, JNI_ABORT);
+        m_elements = nullptr;
+    }
+
+    /*!
+     * \brief Write changes back and release the elements
+     */
+    void release()
+    {
+        if(m_elements)
+            detail::release_elements(m_array, m_elements, 0);
+        m_elements = nullptr;
+    }
+
+    /*!
+     * \brief Whether the JVM handed out a copy instead of pinning the array
+     * \return
+     */
+    bool is_copy() const
+    {
+        return m_copy;
+    }
+
+    value_type* data() const
+    {
+        return m_elements;
+    }
+
+    size_t size() const
+    {
+        return m_size;
+    }
+
+    value_type* begin() const
+    {
+        return m_elements;
+    }
+
+    value_type* end() const
+    {
+        return m_elements + m_size;
+    }
+
+    value_type& operator[](size_t index) const
+    {
+        return m_elements[index];
+    }
+
+    std::span<value_type> span() const
+    {
+        return {m_elements, m_size};
+    }
+
+  private:
+    array_type  m_array;
+    value_type* m_elements = nullptr;
+    size_t      m_size;
+    bool        m_copy = false;
 };
 
 template<return_type T>
+requires(T != return_type::object_)
+/*!
+ * \brief Elements of a primitive array, or a part of it, copied into a vector
+ * with a single Get<Type>ArrayRegion. Unlike pinned_elements, this never
+ * blocks the garbage collector, and changes are only written back with
+ * write(). The vector is allocated from a memory resource, the default one
+ * unless another is given.
+ */
+struct copied_elements
+{
+    using value_type = typename detail::element_type<T>::type;
+    using array_type = typename detail::element_type<T>::array_type;
+
+    /*!
+     * \param array
+     * \param offset first element to copy
+     * \param count number of elements, or -1 for the rest of the array
+     * \param resource
+     */
+    copied_elements(
+        java::array                array,
+        jsize                      offset   = 0,
+        jsize                      count    = -1,
+        std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+        : values(resource)
+        , m_array(reinterpret_cast<array_type>(array.instance))
+        , m_offset(offset)
+    {
+        auto length = static_cast<jsize>(array.length());
+
+        if(count < 0)
+            count = length - offset;
+
+        if(offset < 0 || offset > length || count < 0 ||
+           count > length - offset)
+            throw std::out_of_range(
+                "elements [" + std::to_string(offset) + ", " +
+                std::to_string(offset + count) +
+                ") out of bounds for length " + std::to_string(length));
+
+        values.resize(static_cast<size_t>(count));
+        detail::get_region(m_array, offset, count, values.data());
+        invocation::call::check_exception();
+    }
+
+    /*!
+     * \brief Copy the whole array into memory from resource
+     * \param array
+     * \param resource
+     */
+    copied_elements(java::array array, std::pmr::memory_resource* resource)
+        : copied_elements(array, 0, -1, resource)
+    {
+    }
+
+    /*!
+     * \brief Copy the elements back to the array
+     */
+    void write() const
+    {
+        detail::set_region(
+            m_array,
+            m_offset,
+            static_cast<jsize>(values.size()),
+            values.data());
+        invocation::call::check_exception();
+    }
+
+    value_type* data()
+    {
+        return values.data();
+    }
+
+    size_t size() const
+    {
+        return values.size();
+    }
+
+    value_type* begin()
+    {
+        return values.data();
+    }
+
+    value_type* end()
+    {
+        return values.data() + values.size();
+    }
+
+    value_type& operator[](size_t index)
+    {
+        return values[index];
+    }
+
+    std::span<value_type> span()
+    {
+        return values;
+    }
+
+    std::pmr::vector<value_type> values;
+
+  private:
+    array_type m_array;
+    jsize      m_offset;
+};
+
+template<return_type T, typename Function>
+requires(T != return_type::object_)
+/*!
+ * \brief Copy a primitive array out in chunks, reusing one buffer, and pass
+ * each of them to a function, for arrays that are too large to copy at once
+ * \param array
+ * \param chunk number of elements per chunk, must be positive
+ * \param function called with a std::span of the chunk and the offset of its
+ * first element
+ */
+inline void for_each_chunk(java::array array, jsize chunk, Function&& function)
+{
+    using value_type = typename detail::element_type<T>::type;
+    using array_type = typename detail::element_type<T>::array_type;
+
+    if(chunk <= 0)
+        throw std::invalid_argument("chunk must be positive");
+
+    auto instance = reinterpret_cast<array_type>(array.instance);
+    auto length   = static_cast<jsize>(array.length());
+
+    std::vector<value_type> buffer(
+        static_cast<size_t>(std::min(chunk, length)));
+
+    for(jsize offset = 0; offset < length; offset += chunk)
+    {
+        auto count = std::min(chunk, length - offset);
+
+        detail::get_region(instance, offset, count, buffer.data());
+        invocation::call::check_exception();
+
+        function(
+            std::span<value_type>(buffer.data(), static_cast<size_t>(count)),
+            offset);
+    }
+}
+
+template<return_type T>
+/*!
+ * \brief Random-access range over the elements of an array, reading each of
+ * them through JNI when it is dereferenced. The length is fetched once. Since
+ * every access is a JNI call on the current thread, this suits sequential
+ * algorithms that touch few elements, like lookups and searches. To sort,
+ * or to run parallel algorithms, use copied_elements or pinned_elements,
+ * which are contiguous ranges in native memory.
+ *
+ * Iterators hold the array reference and length themselves, so they stay
+ * valid after the container is gone, eg. when it is a temporary.
+ */
 struct container
 {
     container(java::array arrayObject)
         : m_extractor(arrayObject)
-        , m_end(m_extractor.length())
     {
     }
 
     struct iterator
     {
-        iterator(container<T>& container, jsize idx)
-            : m_ref(container)
-            , m_idx(idx)
+        using value_type      = decltype(std::declval<extract_type<T>&>()[0]);
+        using reference       = value_type;
+        using difference_type = std::ptrdiff_t;
+
+        using iterator_concept = std::random_access_iterator_tag;
+        /* Elements are returned by value, which only makes an input iterator
+         * for the algorithms that predate ranges */
+        using iterator_category = std::input_iterator_tag;
+
+        iterator()
         {
         }
 
-        iterator(container<T>& container)
-            : m_ref(container)
-            , m_idx(m_ref.m_end)
+        iterator(java::array array, jsize length, jsize index)
+            : m_array(array)
+            , m_length(length)
+            , m_index(index)
         {
         }
 
+        value_type operator*() const
+        {
+            return extract_type<T>(m_array, m_length)[m_index];
+        }
+
+        value_type operator[](difference_type offset) const
+        {
+            return extract_type<T>(m_array, m_length)[static_cast<jsize>(
+                m_index + offset)];
+        }
+
         iterator& operator++()
         {
-            if(m_idx >= m_ref.m_end)
-                throw std::out_of_range("no more elements");
+            m_index++;
+            return *this;
+        }
 
-            m_idx++;
+        iterator operator++(int)
+        {
+            auto out = *this;
+            m_index++;
+            return out;
+        }
+
+        iterator& operator--()
+        {
+            m_index--;
+            return *this;
+        }
 
+        iterator operator--(int)
+        {
+            auto out = *this;
+            m_index--;
+            return out;
+        }
+
+        iterator& operator+=(difference_type offset)
+        {
+            m_index = static_cast<jsize>(m_index + offset);
             return *this;
         }
 
-        auto operator*()
+        iterator& operator-=(difference_type offset)
         {
-            return m_ref.m_extractor[m_idx];
+            m_index = static_cast<jsize>(m_index - offset);
+            return *this;
+        }
+
+        friend iterator operator+(iterator it, difference_type offset)
+        {
+            return it += offset;
+        }
+
+        friend iterator operator+(difference_type offset, iterator it)
+        {
+            return it += offset;
+        }
+
+        friend iterator operator-(iterator it, difference_type offset)
+        {
+            return it -= offset;
+        }
+
+        friend difference_type operator-(
+            iterator const& lhs, iterator const& rhs)
+        {
+            return static_cast<difference_type>(lhs.m_index) - rhs.m_index;
         }
 
         bool operator==(iterator const& other) const
         {
-            return other.m_idx == m_idx;
+            return m_index == other.m_index;
         }
 
-        bool operator!=(iterator const& other) const
+        auto operator<=>(iterator const& other) const
         {
-            return other.m_idx != m_idx;
+            return m_index <=> other.m_index;
         }
 
       private:
-        container<T> m_ref;
-        jsize        m_idx;
+        java::array m_array  = {nullptr};
+        jsize       m_length = 0;
+        jsize       m_index  = 0;
     };
 
-    iterator begin()
+    iterator begin() const
+    {
+        return iterator(m_extractor.ref, length(), 0);
+    }
+
+    iterator end() const
+    {
+        return iterator(m_extractor.ref, length(), length());
+    }
+
+    /*!
+     * \brief Number of elements, fetched once
+     * \return
+     */
+    jsize length() const
+    {
+        return static_cast<jsize>(m_extractor.length());
+    }
+
+    size_t size() const
     {
-        return iterator(*this, 0);
+        return static_cast<size_t>(length());
     }
 
-    iterator end()
+    element_ref<T> operator[](jsize index)
     {
-        return iterator(*this);
+        return m_extractor.at(index);
     }
 
   private:
     extract_type<T> m_extractor;
-
-    jsize m_end;
 };
 
+static_assert(std::ranges::random_access_range<container<return_type::int_>>);
+static_assert(
+    std::ranges::random_access_range<container<return_type::object_>>);
+static_assert(
+    std::ranges::contiguous_range<copied_elements<return_type::int_>>);
+
 } // namespace jnipp::java::array_extractors
+
+template<jnipp::return_type T>
+inline constexpr bool std::ranges::enable_borrowed_range<
+    jnipp::java::array_extractors::container<T>> = true;
+
+static_assert(std::ranges::borrowed_range<
+              jnipp::java::array_extractors::container<
+                  jnipp::return_type::int_>>);
@@ -0,0 +1,666 @@
+#pragma once
+
+#include "arrays.h"
+#include "checks.h"
+#include "errors.h"
+#include "expected.h"
+#include "field_access.h"
+#include "jni_types.h"
+#include "method_calls.h"
+#include "monitor.h"
+#include "ref_accounting.h"
+#include "references.h"
+#include "unwrappers.h"
+
+#include <algorithm>
+#include <array>
+#include <optional>
+#include <span>
+#include <tuple>
+#include <utility>
+
+namespace jnipp::batching {
+
+template<return_type Type>
+/*!
+ * \brief Whether a result is a reference, which is returned as a local
+ * reference in the caller's frame
+ */
+constexpr bool is_reference = Type == return_type::object_ ||
+                              Type == return_type::object_array_ ||
+                              Type == return_type::bool_array_ ||
+                              Type == return_type::byte_array_ ||
+                              Type == return_type::char_array_ ||
+                              Type == return_type::short_array_ ||
+                              Type == return_type::int_array_ ||
+                              Type == return_type::long_array_ ||
+                              Type == return_type::float_array_ ||
+                              Type == return_type::double_array_;
+
+/*!
+ * \brief Each step is run with run(), and its result is converted with
+ * finish() once all steps have succeeded. finish() returns a tuple with the
+ * step's result, or an empty tuple if it has none, and does not throw.
+ * Reference results are kept as ::jobject, so that the batch can release
+ * them if a later step fails. Steps that can throw a Java exception set
+ * throws, and temporaries is the number of local references a step may
+ * create besides its result.
+ */
+template<
+    return_type                      Type,
+    invocation::call::calling_method Calling,
+    typename... Args>
+struct call_step
+{
+    static constexpr bool checkpoint = false;
+    static constexpr bool throws     = true;
+
+    /* Arguments passed as jvalues may create references of their own, eg.
+     * for strings */
+    static constexpr jint temporaries =
+        (invocation::arguments::is_direct<Args> && ...) ? 0 : sizeof...(Args);
+
+    using raw_type = std::conditional_t<
+        Type == return_type::void_,
+        std::tuple<>,
+        std::conditional_t<
+            is_reference<Type>,
+            ::jobject,
+            decltype(invocation::call::call_no_except<Type, Calling>(
+                nullptr,
+                nullptr,
+                java::method_handle{},
+                std::declval<Args>()...))>>;
+
+    raw_type run()
+    {
+        return std::apply(
+            [this](Args... args) -> raw_type {
+                using invocation::call::call_no_except;
+
+                if constexpr(Type == return_type::void_)
+                {
+                    call_no_except<Type, Calling>(
+                        clazz, instance, method, args...);
+                    return {};
+                } else if constexpr(is_reference<Type>)
+                    return accounting::track_local(
+                        invocation::call::detail::invoke<Type, Calling>(
+                            clazz, instance, method, args...),
+                        *method);
+                else
+                    return call_no_except<Type, Calling>(
+                        clazz, instance, method, args...);
+            },
+            args);
+    }
+
+    /* The return class is resolved when the call is recorded, which keeps
+     * translate_result() from looking it up */
+    auto finish(raw_type&& raw)
+    {
+        if constexpr(Type == return_type::void_)
+            return std::tuple<>();
+        else if constexpr(
+            Type == return_type::object_ || Type == return_type::object_array_)
+            return std::make_tuple(invocation::call::translate_result<Type>(
+                java::object{nullptr, raw}, method));
+        else if constexpr(is_reference<Type>)
+            return std::make_tuple(invocation::call::translate_result<Type>(
+                reinterpret_cast<::jarray>(raw), method));
+        else
+            return std::make_tuple(raw);
+    }
+
+    ::jclass            clazz;
+    ::jobject           instance;
+    java::method_handle method;
+    std::tuple<Args...> args;
+};
+
+template<return_type Type, typename Field>
+/*!
+ * \brief Read of an instance_field or static_field
+ */
+struct field_step
+{
+    static constexpr bool checkpoint  = false;
+    static constexpr bool throws      = false;
+    static constexpr jint temporaries = 0;
+
+    using raw_type = std::conditional_t<
+        Type == return_type::object_,
+        ::jobject,
+        decltype(*std::declval<Field>())>;
+
+    raw_type run()
+    {
+        if constexpr(Type == return_type::object_)
+            return (*field).object.instance;
+        else
+            return *field;
+    }
+
+    auto finish(raw_type&& raw)
+    {
+        if constexpr(Type == return_type::object_)
+            return std::make_tuple(wrapping::jobject(java::object{{}, raw}));
+        else
+            return std::make_tuple(raw);
+    }
+
+    Field field;
+};
+
+template<return_type Type, typename Field>
+/*!
+ * \brief Write of an instance_field or static_field
+ */
+struct set_step
+{
+    static constexpr bool checkpoint  = false;
+    static constexpr bool throws      = false;
+    static constexpr jint temporaries = 0;
+
+    using raw_type = std::tuple<>;
+
+    raw_type run()
+    {
+        field.set(value);
+        return {};
+    }
+
+    std::tuple<> finish(raw_type&&)
+    {
+        return {};
+    }
+
+    Field                            field;
+    field_access::value_type_t<Type> value;
+};
+
+template<return_type Type>
+/*!
+ * \brief Copy of a primitive array region into memory owned by the caller
+ */
+struct read_step
+{
+    using value_type =
+        typename java::array_extractors::extract_type<Type>::value_type;
+
+    static constexpr bool checkpoint  = false;
+    static constexpr bool throws      = true;
+    static constexpr jint temporaries = 0;
+
+    using raw_type = std::tuple<>;
+
+    raw_type run()
+    {
+        java::array_extractors::detail::get_region(
+            array.array(), offset, static_cast<jsize>(out.size()), out.data());
+        return {};
+    }
+
+    std::tuple<> finish(raw_type&&)
+    {
+        return {};
+    }
+
+    java::array_extractors::extract_type<Type> array;
+    std::span<value_type>                      out;
+    jsize                                      offset;
+};
+
+/*!
+ * \brief Point at which pending exceptions are checked, the remaining steps
+ * are skipped if there is one
+ */
+struct checkpoint_step
+{
+    static constexpr bool checkpoint  = true;
+    static constexpr bool throws      = false;
+    static constexpr jint temporaries = 0;
+
+    using raw_type = std::tuple<>;
+
+    raw_type run()
+    {
+        return {};
+    }
+
+    std::tuple<> finish(raw_type&&)
+    {
+        return {};
+    }
+};
+
+} // namespace jnipp::batching
+
+namespace jnipp {
+
+template<typename... Steps>
+/*!
+ * \brief Recorder for a sequence of calls, field reads and writes, and array
+ * copies, which are run back to back, optionally while holding the monitor
+ * of an object. Pending exceptions are checked after every step that can
+ * throw, and the remaining steps are skipped after the first one. Steps that
+ * cannot throw are only checked at checkpoints, unless the check level is
+ * JNIPP_CHECK_FULL.
+ *
+ * The steps run inside one local frame when any of them creates temporary
+ * references, which are released together when the batch ends. Results are
+ * returned as a tuple, with one element for each step that produces a
+ * value. References are returned in the caller's frame, those of steps that
+ * ran before a failing one are released.
+ */
+struct batch
+{
+    batch()
+    {
+    }
+
+    batch(std::tuple<Steps...>&& steps, ::jobject lock = nullptr)
+        : steps(std::move(steps))
+        , lock(lock)
+    {
+    }
+
+    template<return_type RType, typename... Args>
+    /*!
+     * \brief Add an instance method call
+     * \param method
+     * \param args
+     * \return
+     */
+    auto call(
+        invocation::instance_call<RType, Args...> const& method,
+        std::type_identity_t<Args>... args)
+    {
+        using invocation::call::calling_method;
+
+        return append(
+            batching::call_step<RType, calling_method::instanced_, Args...>{
+                nullptr,
+                method.method.instance,
+                resolved<RType>(method.method.method),
+                {args...},
+            });
+    }
+
+    template<return_type RType, typename... Args>
+    /*!
+     * \brief Add a static method call
+     * \param method
+     * \param args
+     * \return
+     */
+    auto call(
+        invocation::static_call<RType, Args...> const& method,
+        std::type_identity_t<Args>... args)
+    {
+        using invocation::call::calling_method;
+
+        return append(
+            batching::call_step<RType, calling_method::static_, Args...>{
+                method.method.clazz,
+                nullptr,
+                resolved<RType>(method.method.method),
+                {args...},
+            });
+    }
+
+    template<return_type T>
+    /*!
+     * \brief Add a read of an instance field
+     * \param field
+     * \return
+     */
+    auto get(field_access::instance_field<T> const& field)
+    {
+        return append(
+            batching::field_step<T, field_access::instance_field<T>>{field});
+    }
+
+    template<return_type T>
+    /*!
+     * \brief Add a read of a static field
+     * \param field
+     * \return
+     */
+    auto get(field_access::static_field<T> const& field)
+    {
+        return append(
+            batching::field_step<T, field_access::static_field<T>>{field});
+    }
+
+    template<return_type T>
+    /*!
+     * \brief Add a write of an instance field
+     * \param field
+     * \param value
+     * \return
+     */
+    auto set(
+        field_access::instance_field<T> const& field,
+        field_access::value_type_t<T>          value)
+    {
+        return append(
+            batching::set_step<T, field_access::instance_field<T>>{
+                field, value});
+    }
+
+    template<return_type T>
+    /*!
+     * \brief Add a write of a static field
+     * \param field
+     * \param value
+     * \return
+     */
+    auto set(
+        field_access::static_field<T> const& field,
+        field_access::value_type_t<T>        value)
+    {
+        return append(
+            batching::set_step<T, field_access::static_field<T>>{
+                field, value});
+    }
+
+    template<return_type T>
+    requires(T != return_type::object_)
+    /*!
+     * \brief Add a copy out of a primitive array
+     * \param array
+     * \param out destination, which must stay valid until the batch is run
+     * \param offset first element of the array to copy
+     * \return
+     */
+    auto read(
+        java::array_type_unwrapper<T> const& array,
+        std::span<typename batching::read_step<T>::value_type> out,
+        jsize                                                  offset = 0)
+    {
+        return append(batching::read_step<T>{
+            java::array_extractors::extract_type<T>(array.arrayRef),
+            out,
+            offset,
+        });
+    }
+
+    /*!
+     * \brief Check for a pending exception at this point, skipping the rest
+     * of the batch if there is one
+     * \return
+     */
+    auto checkpoint()
+    {
+        return append(batching::checkpoint_step{});
+    }
+
+    /*!
+     * \brief Hold the monitor of an object while the batch runs, as if it
+     * were run in a synchronized block, so that a group of updates takes the
+     * lock once. The monitor is released before any exception is thrown.
+     * \param object must stay valid until the batch is run
+     * \return
+     */
+    batch synchronized_on(wrapping::jobject const& object)
+    {
+        return {std::tuple<Steps...>(steps), object.object.instance};
+    }
+
+    /*!
+     * \brief Run the batch, throwing the first Java exception
+     * \return tuple of results
+     */
+    auto run()
+    {
+        raw_results raw;
+
+        if(!execute(raw))
+            invocation::call::check_exception();
+
+        return finish(raw);
+    }
+
+    /*!
+     * \brief Run the batch, returning either the results or the first Java
+     * exception
+     * \return jnipp::expected holding a tuple of results
+     */
+    auto try_run()
+    {
+        raw_results raw;
+
+        using result_type = decltype(finish(raw));
+
+        if(!execute(raw))
+        {
+            auto env       = GetJNI();
+            auto throwable = env->ExceptionOccurred();
+            env->ExceptionClear();
+            return expected<result_type>(java_error(throwable));
+        }
+
+        return expected<result_type>(finish(raw));
+    }
+
+    std::tuple<Steps...> steps;
+
+    /* Object whose monitor is held, if any */
+    ::jobject lock = nullptr;
+
+  private:
+    using raw_results = std::tuple<typename Steps::raw_type...>;
+
+    /* Number of steps returning a reference */
+    static constexpr jint references =
+        (0 + ... + std::is_same_v<typename Steps::raw_type, ::jobject>);
+
+    /* Number of local references the steps may create besides results */
+    static constexpr jint temporaries = (0 + ... + Steps::temporaries);
+
+    template<return_type RType>
+    /*!
+     * \brief Resolve the class of returned objects while recording, so that
+     * converting the results cannot fail once the batch has run
+     * \param method
+     * \return
+     */
+    static java::method_handle resolved(java::method_handle method)
+    {
+        if constexpr(
+            RType == return_type::object_ ||
+            RType == return_type::object_array_)
+        {
+            if(method.return_clazz)
+                return method;
+
+            if(!method.return_class)
+                throw std::runtime_error("no return class provided");
+
+            method.return_clazz =
+                cache::descriptors().clazz(method.return_class);
+            invocation::call::check_exception();
+        }
+
+        return method;
+    }
+
+    template<typename Step>
+    batch<Steps..., Step> append(Step&& step)
+    {
+        return {
+            std::tuple_cat(steps, std::make_tuple(std::move(step))),
+            lock,
+        };
+    }
+
+    /*!
+     * \brief Run the steps up to the first exception
+     * \param raw
+     * \return false if an exception is pending, the references of the steps
+     * that ran are released by then
+     */
+    bool execute(raw_results& raw)
+    {
+        auto env = GetJNI();
+
+        if constexpr(temporaries == 0)
+        {
+            if constexpr(references > 0)
+                if(env->EnsureLocalCapacity(references) != JNI_OK)
+                    return false;
+
+            if(run_steps(raw, env))
+                return true;
+
+            discard(raw);
+            return false;
+        } else
+        {
+            /* Popping the frame without a result releases everything,
+             * including the results of a failed batch */
+            local_frame frame(references + temporaries + 1, env);
+
+            if(!frame)
+                return false;
+
+            return run_steps(raw, env) && keep(frame, raw, env);
+        }
+    }
+
+    bool run_steps(raw_results& raw, JNIEnv* env)
+    {
+        std::optional<monitor_scope> held;
+        if(lock)
+            held.emplace(lock, env);
+
+        bool ok = true;
+
+        [&]<size_t... I>(std::index_sequence<I...>) {
+            ((ok = ok && run_step<I>(raw, env)), ...);
+        }(std::index_sequence_for<Steps...>());
+
+        return ok;
+    }
+
+    template<size_t I>
+    bool run_step(raw_results& raw, JNIEnv* env)
+    {
+        using step = std::tuple_element_t<I, std::tuple<Steps...>>;
+
+        std::get<I>(raw) = std::get<I>(steps).run();
+
+        if constexpr(step::throws || step::checkpoint || checks::batch_steps)
+            return env->ExceptionCheck() == JNI_FALSE;
+        else
+            return true;
+    }
+
+    /*!
+     * \brief Release the references returned by the steps that ran
+     * \param raw
+     */
+    void discard(raw_results& raw)
+    {
+        auto env = GetJNI();
+
+        std::apply(
+            [env](auto&... values) {
+                (
+                    [env](auto& value) {
+                        using value_type = std::remove_cvref_t<decltype(value)>;
+
+                        if constexpr(std::is_same_v<value_type, ::jobject>)
+                            if(value)
+                            {
+                                if constexpr(accounting::enabled)
+                                    accounting::local_released(value);
+                                env->DeleteLocalRef(value);
+                            }
+                    }(values),
+                    ...);
+            },
+            raw);
+    }
+
+    /*!
+     * \brief Pop the batch's frame, keeping the reference results alive in
+     * the caller's frame. PopLocalFrame() only keeps one reference, more are
+     * carried out in an Object[].
+     * \param frame
+     * \param raw
+     * \param env
+     * \return false if an exception is pending
+     */
+    bool keep(local_frame& frame, raw_results& raw, JNIEnv* env)
+    {
+        if constexpr(references > 0)
+        {
+            std::array<::jobject*, references> results;
+
+            std::apply(
+                [&results](auto&... values) {
+                    size_t i = 0;
+                    (
+                        [&](auto& value) {
+                            using value_type =
+                                std::remove_cvref_t<decltype(value)>;
+
+                            if constexpr(std::is_same_v<value_type, ::jobject>)
+                                results[i++] = &value;
+                        }(values),
+                        ...);
+                },
+                raw);
+
+            std::array<std::string, accounting::enabled ? references : 0>
+                sites;
+
+            if constexpr(accounting::enabled)
+                for(size_t i = 0; i < results.size(); i++)
+                    sites[i] = accounting::local_site(*results[i]);
+
+            if constexpr(references == 1)
+                *results[0] = frame.pop(*results[0]);
+            else
+            {
+                auto Object = cache::classes().resolve("java/lang/Object", env);
+
+                if(!Object)
+                    return false;
+
+                auto kept = env->NewObjectArray(references, Object, nullptr);
+
+                if(!kept)
+                    return false;
+
+                for(jsize i = 0; i < references; i++)
+                    env->SetObjectArrayElement(kept, i, *results[i]);
+
+                kept = reinterpret_cast<::jobjectArray>(frame.pop(kept));
+
+                for(jsize i = 0; i < references; i++)
+                    *results[i] = env->GetObjectArrayElement(kept, i);
+
+                env->DeleteLocalRef(kept);
+            }
+
+            if constexpr(accounting::enabled)
+                for(size_t i = 0; i < results.size(); i++)
+                    accounting::local_created(*results[i], sites[i]);
+        }
+
+        return true;
+    }
+
+    auto finish(raw_results& raw)
+    {
+        return [&]<size_t... I>(std::index_sequence<I...>) {
+            return std::tuple_cat(
+                std::get<I>(steps).finish(std::move(std::get<I>(raw)))...);
+        }(std::index_sequence_for<Steps...>());
+    }
+};
+
+} // namespace jnipp
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "checks.h"
+#include "class_wrapper.h"
+#include "method_call_impl.h"
+#include "object_test.h"
+
+namespace jnipp::wrapping {
+
+template<return_type RType, typename... Args>
+/*!
+ * \brief An instance method resolved once against a class, which can be
+ * invoked on any instance of that class without looking up the method again.
+ * Use these for calls inside hot loops.
+ */
+struct bound_method
+{
+    /*!
+     * \brief Resolve the method ID for method in clazz
+     * \param clazz
+     * \param method
+     */
+    bound_method(jclass const& clazz, jmethod<RType, Args...> const& method)
+        : clazz(clazz.clazz)
+        , method{
+              cache::method_id(clazz.clazz, method.method, false),
+              method.method.return_class,
+              nullptr,
+          }
+    {
+        if constexpr(checks::lookups)
+            invocation::call::check_exception();
+
+        this->method.return_clazz =
+            cache::descriptors().clazz(method.method.return_class);
+
+        if constexpr(checks::lookups)
+            invocation::call::check_exception();
+    }
+
+    /*!
+     * \brief Call the method on instance, which must be an instance of the
+     * class the method was bound with. This is verified depending on
+     * checks::types.
+     * \param instance
+     * \param args
+     * \return
+     */
+    inline auto operator()(jobject const& instance, Args... args) const
+    {
+        if constexpr(checks::types)
+            java::objects::verify_instance_of(instance.object, clazz);
+
+        using invocation::call::calling_method;
+
+        if constexpr(RType == return_type::void_)
+            invocation::call::call<RType, calling_method::instanced_>(
+                {}, instance.object, method, std::forward<Args>(args)...);
+        else
+            return invocation::call::call<RType, calling_method::instanced_>(
+                {}, instance.object, method, std::forward<Args>(args)...);
+    }
+
+    /*!
+     * \brief Call the method on instance, returning a jnipp::expected with
+     * the result or the Java exception instead of throwing
+     * \param instance
+     * \param args
+     * \return
+     */
+    inline auto try_call(jobject const& instance, Args... args) const
+    {
+        if constexpr(checks::types)
+            java::objects::verify_instance_of(instance.object, clazz);
+
+        return invocation::call::try_call<
+            RType,
+            invocation::call::calling_method::instanced_>(
+            {}, instance.object, method, std::forward<Args>(args)...);
+    }
+
+    ::jclass            clazz;
+    java::method_handle method;
+};
+
+} // namespace jnipp::wrapping
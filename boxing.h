@@ -0,0 +1,265 @@
+#pragma once
+
+#include "arrays.h"
+#include "cache.h"
+#include "checks.h"
+#include "jni_types.h"
+#include "ref_accounting.h"
+#include "type_signatures.h"
+#include "unwrappers.h"
+#include "wrappers.h"
+
+#include <memory_resource>
+#include <type_traits>
+#include <vector>
+
+namespace jnipp::java {
+
+namespace detail {
+
+template<typename T>
+/*!
+ * \brief Class and method IDs for boxing and unboxing T, resolved once
+ */
+struct box_metadata
+{
+    static box_metadata const& get()
+    {
+        static const box_metadata metadata;
+        return metadata;
+    }
+
+    ::jclass    clazz;
+    ::jmethodID valueOf;
+    ::jmethodID unbox;
+
+  private:
+    box_metadata()
+    {
+        auto signature = type_signature::to_str<T>();
+        auto boxed     = type_signature::to_str<java::boxed<T>>();
+
+        clazz   = cache::classes().resolve(type_signature::boxed_class<T>());
+        valueOf = cache::method_id(
+            clazz, "valueOf", ("(" + signature + ")" + boxed).c_str(), true);
+        unbox = cache::method_id(
+            clazz, unbox_name(), ("()" + signature).c_str(), false);
+    }
+
+    static constexpr const char* unbox_name()
+    {
+        if constexpr(std::is_same_v<T, jboolean>)
+            return "booleanValue";
+        else if constexpr(std::is_same_v<T, jbyte>)
+            return "byteValue";
+        else if constexpr(std::is_same_v<T, jchar>)
+            return "charValue";
+        else if constexpr(std::is_same_v<T, jshort>)
+            return "shortValue";
+        else if constexpr(std::is_same_v<T, jint>)
+            return "intValue";
+        else if constexpr(std::is_same_v<T, jlong>)
+            return "longValue";
+        else if constexpr(std::is_same_v<T, jfloat>)
+            return "floatValue";
+        else if constexpr(std::is_same_v<T, jdouble>)
+            return "doubleValue";
+    }
+};
+
+} // namespace detail
+
+template<typename T>
+/*!
+ * \brief Box a primitive with T.valueOf()
+ * \param value
+ * \return a local reference to the box
+ */
+inline ::jobject box(T value)
+{
+    auto const& meta = detail::box_metadata<T>::get();
+    auto        env  = GetJNI();
+
+    auto out = env->CallStaticObjectMethod(meta.clazz, meta.valueOf, value);
+    invocation::call::check_exception();
+
+    if constexpr(accounting::enabled)
+        accounting::local_created(out, "<box>");
+
+    return out;
+}
+
+template<typename T>
+/*!
+ * \brief Unbox a primitive, the box must not be null
+ * \param box
+ * \return
+ */
+inline T unbox(::jobject box)
+{
+    auto const& meta = detail::box_metadata<T>::get();
+    auto        env  = GetJNI();
+
+    T out;
+
+    if constexpr(std::is_same_v<T, jboolean>)
+        out = env->CallBooleanMethod(box, meta.unbox);
+    else if constexpr(std::is_same_v<T, jbyte>)
+        out = env->CallByteMethod(box, meta.unbox);
+    else if constexpr(std::is_same_v<T, jchar>)
+        out = env->CallCharMethod(box, meta.unbox);
+    else if constexpr(std::is_same_v<T, jshort>)
+        out = env->CallShortMethod(box, meta.unbox);
+    else if constexpr(std::is_same_v<T, jint>)
+        out = env->CallIntMethod(box, meta.unbox);
+    else if constexpr(std::is_same_v<T, jlong>)
+        out = env->CallLongMethod(box, meta.unbox);
+    else if constexpr(std::is_same_v<T, jfloat>)
+        out = env->CallFloatMethod(box, meta.unbox);
+    else if constexpr(std::is_same_v<T, jdouble>)
+        out = env->CallDoubleMethod(box, meta.unbox);
+
+    invocation::call::check_exception();
+    return out;
+}
+
+template<typename T>
+/*!
+ * \brief Passes a boxed<T> argument as a new box. The box is a local
+ * reference that is not released after the call, it belongs to the
+ * caller's frame: it goes away when the native method returns, or with the
+ * enclosing local_frame. Calls made in a loop should open a local_frame per
+ * iteration.
+ */
+struct type_wrapper<boxed<T>>
+{
+    type_wrapper(boxed<T> value)
+        : value(value)
+    {
+    }
+
+    operator jvalue() const
+    {
+        jvalue out;
+        out.l = box(value.value);
+        return out;
+    }
+
+    boxed<T> value;
+};
+
+template<typename T>
+struct type_unwrapper<boxed<T>>
+{
+    type_unwrapper(java::object value)
+        : value(value)
+    {
+    }
+
+    operator T() const
+    {
+        if constexpr(checks::types)
+            objects::verify_instance_of(
+                value, detail::box_metadata<T>::get().clazz);
+
+        return unbox<T>(value);
+    }
+
+    java::object value;
+};
+
+namespace detail {
+
+template<typename Vector>
+inline Vector unbox_into(
+    java::array const&          array,
+    typename Vector::value_type null_value,
+    Vector                      out)
+{
+    using T = typename Vector::value_type;
+
+    auto env    = GetJNI();
+    auto values = reinterpret_cast<jobjectArray>(array.instance);
+
+    /* Checked once for the array, rather than per element */
+    if constexpr(checks::types)
+        objects::verify_instance_of(
+            array.instance, "[" + type_signature::to_str<java::boxed<T>>());
+
+    auto length = env->GetArrayLength(values);
+
+    out.reserve(length);
+
+    for(jsize i = 0; i < length; i++)
+    {
+        auto element = env->GetObjectArrayElement(values, i);
+
+        if(!element)
+        {
+            out.push_back(null_value);
+            continue;
+        }
+
+        if constexpr(accounting::enabled)
+            accounting::local_created(element, "<array element>");
+
+        out.push_back(unbox<T>(element));
+
+        if constexpr(accounting::enabled)
+            accounting::local_released(element);
+        env->DeleteLocalRef(element);
+    }
+
+    return out;
+}
+
+} // namespace detail
+
+template<typename T>
+/*!
+ * \brief Unbox an array of boxes, eg. Integer[], into a vector
+ * \param array
+ * \param null_value value used for null elements
+ * \return
+ */
+inline std::vector<T> unbox_array(java::array const& array, T null_value = {})
+{
+    return detail::unbox_into(array, null_value, std::vector<T>());
+}
+
+template<typename T>
+inline std::vector<T> unbox_array(
+    array_type_unwrapper<return_type::object_> const& array, T null_value = {})
+{
+    return unbox_array<T>(array.arrayRef, null_value);
+}
+
+template<typename T, typename Resource>
+requires std::is_convertible_v<Resource*, std::pmr::memory_resource*>
+/*!
+ * \brief Unbox an array of boxes into a vector allocated from a memory
+ * resource. The resource is deduced, so that a literal 0 passed as
+ * null_value to the overload above is never taken for a pointer.
+ * \param array
+ * \param resource
+ * \param null_value value used for null elements
+ * \return
+ */
+inline std::pmr::vector<T> unbox_array(
+    java::array const& array, Resource* resource, T null_value = {})
+{
+    return detail::unbox_into(
+        array, null_value, std::pmr::vector<T>(resource));
+}
+
+template<typename T, typename Resource>
+requires std::is_convertible_v<Resource*, std::pmr::memory_resource*>
+inline std::pmr::vector<T> unbox_array(
+    array_type_unwrapper<return_type::object_> const& array,
+    Resource*                                         resource,
+    T                                                 null_value = {})
+{
+    return unbox_array<T>(array.arrayRef, resource, null_value);
+}
+
+} // namespace jnipp::java
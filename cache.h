@@ -0,0 +1,709 @@
+#pragma once
+
+#include "jni_types.h"
+#include "ref_accounting.h"
+
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <shared_mutex>
+#include <string_view>
+#include <unordered_map>
+
+namespace jnipp::cache {
+
+/*!
+ * \brief Process-wide cache of classes by their slashed name. Classes are kept
+ * as global references, and are never released, so a cached ::jclass is
+ * valid on all threads for the lifetime of the JVM.
+ */
+struct class_cache
+{
+    /*!
+     * \brief Look up a class without resolving it
+     * \param name slashed class name, eg. java/lang/String
+     * \return the cached class, or nullptr
+     */
+    ::jclass find(std::string_view name) const
+    {
+        std::shared_lock _(m_lock);
+
+        auto it = m_classes.find(name);
+        return it != m_classes.end() ? it->second : nullptr;
+    }
+
+    /*!
+     * \brief Look up a class, resolving and caching it with FindClass, or
+     * the class loader if one is set, if it is not already known. If the
+     * lookup fails, nullptr is returned and the Java exception is left
+     * pending.
+     * \param name slashed class name, eg. java/lang/String
+     * \param env
+     * \return
+     */
+    ::jclass resolve(std::string const& name, JNIEnv* env = GetJNI())
+    {
+        if(auto clazz = find(name))
+            return clazz;
+
+        auto local = load(name, env);
+
+        if(!local)
+            return nullptr;
+
+        return insert(name, local, env);
+    }
+
+    /*!
+     * \brief Resolve classes through a ClassLoader instead of FindClass.
+     * On threads attached from native code, FindClass only sees the system
+     * class loader, so application classes must be loaded through the loader
+     * that loaded the application, eg. the one from
+     * capture_class_loader(). Array classes still go through FindClass.
+     *
+     * A loader that is replaced keeps its global reference for the lifetime
+     * of the process, since a lookup on another thread may still be using
+     * it. Loaders live that long in practice anyway.
+     * \param loader a java.lang.ClassLoader, a global reference is kept
+     * \param env
+     * \return false if ClassLoader.loadClass could not be resolved, with
+     * the Java exception left pending
+     */
+    bool set_class_loader(::jobject loader, JNIEnv* env = GetJNI())
+    {
+        auto ClassLoader = env->FindClass("java/lang/ClassLoader");
+
+        if(!ClassLoader)
+            return false;
+
+        auto loadClass = env->GetMethodID(
+            ClassLoader, "loadClass", "(Ljava/lang/String;)Ljava/lang/Class;");
+        env->DeleteLocalRef(ClassLoader);
+
+        if(!loadClass)
+            return false;
+
+        auto global = loader ? env->NewGlobalRef(loader) : nullptr;
+
+        std::unique_lock _(m_lock);
+
+        m_loader    = global;
+        m_loadClass = loadClass;
+
+        return true;
+    }
+
+    /*!
+     * \brief Use the ClassLoader of an already resolved application class
+     * for all further lookups. Call this from a thread where FindClass sees
+     * the application classes, eg. from JNI_OnLoad.
+     * \param anchor any class loaded by the application class loader
+     * \param env
+     * \return false on failure, with the Java exception left pending
+     */
+    bool capture_class_loader(::jclass anchor, JNIEnv* env = GetJNI())
+    {
+        auto Class          = env->GetObjectClass(anchor);
+        auto getClassLoader = env->GetMethodID(
+            Class, "getClassLoader", "()Ljava/lang/ClassLoader;");
+        env->DeleteLocalRef(Class);
+
+        if(!getClassLoader)
+            return false;
+
+        auto loader = env->CallObjectMethod(anchor, getClassLoader);
+
+        if(env->ExceptionCheck() == JNI_TRUE)
+        {
+            env->DeleteLocalRef(loader);
+            return false;
+        }
+
+        auto ok = set_class_loader(loader, env);
+        env->DeleteLocalRef(loader);
+
+        return ok;
+    }
+
+    /*!
+     * \brief Add a class to the cache, taking over the local reference
+     * \param name slashed class name
+     * \param local a local reference to the class, which is released
+     * \param env
+     * \return the cached global reference for the class
+     */
+    ::jclass insert(std::string const& name, ::jclass local, JNIEnv* env)
+    {
+        auto global = reinterpret_cast<::jclass>(env->NewGlobalRef(local));
+        env->DeleteLocalRef(local);
+
+        std::unique_lock _(m_lock);
+
+        auto [it, inserted] = m_classes.emplace(name, global);
+
+        /* Another thread got here first */
+        if(!inserted)
+        {
+            env->DeleteGlobalRef(global);
+            return it->second;
+        }
+
+        m_names.emplace(global, name);
+        return global;
+    }
+
+    /*!
+     * \brief Look up a class that the library ships itself, defining it from
+     * a class file if the VM does not know it yet. It is defined in the
+     * bootstrap class loader, where another library in the process may have
+     * defined it already. If both fail, nullptr is returned and the Java
+     * exception is left pending.
+     * \param name slashed class name
+     * \param bytes class file
+     * \param size
+     * \param env
+     * \return the cached global reference for the class
+     */
+    ::jclass define(
+        std::string const&   name,
+        const unsigned char* bytes,
+        size_t               size,
+        JNIEnv*              env = GetJNI())
+    {
+        if(auto clazz = find(name))
+            return clazz;
+
+        auto local = env->FindClass(name.c_str());
+
+        if(!local)
+        {
+            env->ExceptionClear();
+            local = env->DefineClass(
+                name.c_str(),
+                nullptr,
+                reinterpret_cast<const jbyte*>(bytes),
+                static_cast<jsize>(size));
+        }
+
+        if(!local)
+            return nullptr;
+
+        return insert(name, local, env);
+    }
+
+    /*!
+     * \brief Check if a class reference is owned by the cache, in which case
+     * it may be used as a stable key for other caches
+     * \param clazz
+     * \return
+     */
+    bool owns(::jclass clazz) const
+    {
+        std::shared_lock _(m_lock);
+
+        return m_names.count(clazz);
+    }
+
+    /*!
+     * \brief Get the name of a cached class
+     * \param clazz
+     * \return slashed class name, or empty if the class is not cached
+     */
+    std::string name_of(::jclass clazz) const
+    {
+        std::shared_lock _(m_lock);
+
+        auto it = m_names.find(clazz);
+        return it != m_names.end() ? it->second : std::string();
+    }
+
+  private:
+    ::jclass load(std::string const& name, JNIEnv* env) const
+    {
+        ::jobject   loader    = nullptr;
+        ::jmethodID loadClass = nullptr;
+
+        {
+            std::shared_lock _(m_lock);
+            loader    = m_loader;
+            loadClass = m_loadClass;
+        }
+
+        if(!loader || name.empty() || name.front() == '[')
+            return env->FindClass(name.c_str());
+
+        auto dotted = name;
+        std::replace(dotted.begin(), dotted.end(), '/', '.');
+
+        auto jname = env->NewStringUTF(dotted.c_str());
+        auto clazz = env->CallObjectMethod(loader, loadClass, jname);
+        env->DeleteLocalRef(jname);
+
+        if(env->ExceptionCheck() == JNI_TRUE)
+            return nullptr;
+
+        return reinterpret_cast<::jclass>(clazz);
+    }
+
+    struct name_hash
+    {
+        using is_transparent = void;
+
+        size_t operator()(std::string_view name) const
+        {
+            return std::hash<std::string_view>()(name);
+        }
+    };
+
+    mutable std::shared_mutex m_lock;
+
+    std::unordered_map<std::string, ::jclass, name_hash, std::equal_to<>>
+                                              m_classes;
+    std::unordered_map<::jclass, std::string> m_names;
+
+    ::jobject   m_loader    = nullptr;
+    ::jmethodID m_loadClass = nullptr;
+};
+
+/*!
+ * \brief Cache of method or field IDs, keyed on class, name, signature and
+ * whether the member is static. Only classes owned by the class cache are
+ * used as keys, since other class references may be released and reused.
+ */
+template<typename IdType>
+struct member_cache
+{
+    struct key_view
+    {
+        ::jclass         clazz;
+        std::string_view name;
+        std::string_view signature;
+        bool             is_static;
+    };
+
+    struct key
+    {
+        key(key_view const& view)
+            : clazz(view.clazz)
+            , name(view.name)
+            , signature(view.signature)
+            , is_static(view.is_static)
+        {
+        }
+
+        operator key_view() const
+        {
+            return {clazz, name, signature, is_static};
+        }
+
+        ::jclass    clazz;
+        std::string name;
+        std::string signature;
+        bool        is_static;
+    };
+
+    IdType find(key_view const& member) const
+    {
+        std::shared_lock _(m_lock);
+
+        auto it = m_ids.find(member);
+        return it != m_ids.end() ? it->second : nullptr;
+    }
+
+    void insert(key_view const& member, IdType id)
+    {
+        std::unique_lock _(m_lock);
+
+        m_ids.emplace(key(member), id);
+    }
+
+  private:
+    struct key_hash
+    {
+        using is_transparent = void;
+
+        size_t operator()(key_view const& k) const
+        {
+            auto h = std::hash<::jclass>()(k.clazz);
+            h ^= std::hash<std::string_view>()(k.name) + (h << 6) + (h >> 2);
+            h ^= std::hash<std::string_view>()(k.signature) + (h << 6) +
+                 (h >> 2);
+            return h ^ k.is_static;
+        }
+
+        size_t operator()(key const& k) const
+        {
+            return (*this)(static_cast<key_view>(k));
+        }
+    };
+
+    struct key_equal
+    {
+        using is_transparent = void;
+
+        bool operator()(key_view const& a, key_view const& b) const
+        {
+            return a.clazz == b.clazz && a.is_static == b.is_static &&
+                   a.name == b.name && a.signature == b.signature;
+        }
+    };
+
+    mutable std::shared_mutex m_lock;
+
+    std::unordered_map<key, IdType, key_hash, key_equal> m_ids;
+};
+
+template<typename IdType>
+/*!
+ * \brief ID storage for a single site, eg. a string literal. It keeps the ID
+ * for each class and signature it is resolved for, which are then found by
+ * walking a short list without hashing or locking. Once it is full, other
+ * classes and signatures fall through to the member cache.
+ */
+struct member_slot
+{
+    static constexpr size_t capacity = 8;
+
+    member_slot()
+    {
+    }
+
+    member_slot(member_slot const&) = delete;
+    member_slot& operator=(member_slot const&) = delete;
+
+    ~member_slot()
+    {
+        auto entry = m_head.load();
+
+        while(entry)
+        {
+            auto next = entry->next;
+            delete entry;
+            entry = next;
+        }
+    }
+
+    IdType find(
+        ::jclass clazz, std::string_view signature, bool is_static) const
+    {
+        for(auto entry = m_head.load(std::memory_order_acquire); entry;
+            entry      = entry->next)
+            if(entry->clazz == clazz && entry->is_static == is_static &&
+               entry->signature == signature)
+                return entry->id;
+
+        return nullptr;
+    }
+
+    /*!
+     * \brief Remember an ID, unless the slot is full
+     * \param clazz a class owned by the class cache
+     * \param signature
+     * \param is_static
+     * \param id
+     */
+    void store(
+        ::jclass clazz, std::string_view signature, bool is_static, IdType id)
+    {
+        auto head = m_head.load(std::memory_order_acquire);
+
+        size_t count = 0;
+        for(auto entry = head; entry; entry = entry->next)
+            count++;
+
+        if(count >= capacity)
+            return;
+
+        auto entry =
+            new slot_entry{clazz, std::string(signature), is_static, id, head};
+
+        /* Entries are only ever prepended, so a racing store at worst adds
+         * the same ID twice */
+        while(!m_head.compare_exchange_weak(
+            entry->next,
+            entry,
+            std::memory_order_release,
+            std::memory_order_acquire))
+            ;
+    }
+
+  private:
+    struct slot_entry
+    {
+        ::jclass          clazz;
+        std::string       signature;
+        bool              is_static;
+        IdType            id;
+        slot_entry const* next;
+    };
+
+    std::atomic<slot_entry const*> m_head = nullptr;
+};
+
+/*!
+ * \brief Interning table for class names and signatures, which lets the
+ * invocation layer refer to them by a small index instead of copying strings
+ */
+struct descriptor_table
+{
+    java::descriptor intern(std::string_view value)
+    {
+        {
+            std::shared_lock _(m_lock);
+
+            auto it = m_indices.find(value);
+            if(it != m_indices.end())
+                return it->second;
+        }
+
+        std::unique_lock _(m_lock);
+
+        auto it = m_indices.find(value);
+        if(it != m_indices.end())
+            return it->second;
+
+        m_values.emplace_back(value);
+
+        auto index = static_cast<java::descriptor>(m_values.size());
+        m_indices.emplace(m_values.back().value, index);
+        return index;
+    }
+
+    /*!
+     * \brief Get the string for an interned descriptor
+     * \param index
+     * \return the string, which stays valid for the lifetime of the program
+     */
+    std::string const& lookup(java::descriptor index) const
+    {
+        static const std::string none;
+
+        if(index == 0)
+            return none;
+
+        std::shared_lock _(m_lock);
+
+        return m_values.at(index - 1).value;
+    }
+
+    /*!
+     * \brief Get the class named by a descriptor, resolving it through the
+     * class cache only the first time. If the lookup fails, nullptr is
+     * returned and the Java exception is left pending.
+     * \param index a descriptor holding a slashed class name
+     * \param env
+     * \return
+     */
+    ::jclass clazz(java::descriptor index, JNIEnv* env = GetJNI());
+
+  private:
+    struct entry
+    {
+        entry(std::string_view value)
+            : value(value)
+        {
+        }
+
+        std::string           value;
+        std::atomic<::jclass> clazz = nullptr;
+    };
+
+    mutable std::shared_mutex m_lock;
+
+    /* std::deque does not move its elements, so the views stay valid */
+    std::deque<entry>                                      m_values;
+    std::unordered_map<std::string_view, java::descriptor> m_indices;
+};
+
+inline class_cache& classes()
+{
+    static class_cache cache;
+    return cache;
+}
+
+inline descriptor_table& descriptors()
+{
+    static descriptor_table table;
+    return table;
+}
+
+inline ::jclass descriptor_table::clazz(java::descriptor index, JNIEnv* env)
+{
+    if(index == 0)
+        return nullptr;
+
+    entry* slot = nullptr;
+
+    {
+        std::shared_lock _(m_lock);
+        slot = &m_values.at(index - 1);
+    }
+
+    if(auto resolved = slot->clazz.load(std::memory_order_acquire))
+        return resolved;
+
+    auto resolved = classes().resolve(slot->value, env);
+
+    if(resolved)
+        slot->clazz.store(resolved, std::memory_order_release);
+
+    return resolved;
+}
+
+inline member_cache<::jmethodID>& methods()
+{
+    static member_cache<::jmethodID> cache;
+    return cache;
+}
+
+inline member_cache<::jfieldID>& fields()
+{
+    static member_cache<::jfieldID> cache;
+    return cache;
+}
+
+namespace detail {
+
+/*!
+ * \brief Name of a member for the reference accounting, qualified with its
+ * class when the class is cached
+ * \param clazz
+ * \param name
+ * \return
+ */
+inline std::string site_name(::jclass clazz, const char* name)
+{
+    auto owner = classes().name_of(clazz);
+    return owner.empty() ? std::string(name) : owner + "." + name;
+}
+
+} // namespace detail
+
+/*!
+ * \brief Resolve a method ID through the cache. On failure, nullptr is
+ * returned and the Java exception is left pending.
+ * \param clazz
+ * \param name
+ * \param signature
+ * \param is_static
+ * \param env
+ * \return
+ */
+inline ::jmethodID method_id(
+    ::jclass    clazz,
+    const char* name,
+    const char* signature,
+    bool        is_static,
+    JNIEnv*     env = GetJNI())
+{
+    auto cacheable = classes().owns(clazz);
+
+    if(cacheable)
+        if(auto id = methods().find({clazz, name, signature, is_static}))
+            return id;
+
+    auto id = is_static ? env->GetStaticMethodID(clazz, name, signature)
+                        : env->GetMethodID(clazz, name, signature);
+
+    if(id && cacheable)
+        methods().insert({clazz, name, signature, is_static}, id);
+
+    if constexpr(accounting::enabled)
+        if(id)
+            accounting::name_site(id, detail::site_name(clazz, name));
+
+    return id;
+}
+
+/*!
+ * \brief Resolve a field ID through the cache. On failure, nullptr is
+ * returned and the Java exception is left pending.
+ * \param clazz
+ * \param name
+ * \param signature
+ * \param is_static
+ * \param env
+ * \return
+ */
+inline ::jfieldID field_id(
+    ::jclass    clazz,
+    const char* name,
+    const char* signature,
+    bool        is_static,
+    JNIEnv*     env = GetJNI())
+{
+    auto cacheable = classes().owns(clazz);
+
+    if(cacheable)
+        if(auto id = fields().find({clazz, name, signature, is_static}))
+            return id;
+
+    auto id = is_static ? env->GetStaticFieldID(clazz, name, signature)
+                        : env->GetFieldID(clazz, name, signature);
+
+    if(id && cacheable)
+        fields().insert({clazz, name, signature, is_static}, id);
+
+    if constexpr(accounting::enabled)
+        if(id)
+            accounting::name_site(id, detail::site_name(clazz, name));
+
+    return id;
+}
+
+/*!
+ * \brief Resolve a method ID, checking the method's own slot first
+ * \param clazz
+ * \param method
+ * \param is_static
+ * \param env
+ * \return
+ */
+inline ::jmethodID method_id(
+    ::jclass            clazz,
+    java::method const& method,
+    bool                is_static,
+    JNIEnv*             env = GetJNI())
+{
+    if(method.slot)
+        if(auto id = method.slot->find(clazz, method.signature, is_static))
+            return id;
+
+    auto id = method_id(
+        clazz, method.name.c_str(), method.signature.c_str(), is_static, env);
+
+    if(id && method.slot && classes().owns(clazz))
+        method.slot->store(clazz, method.signature, is_static, id);
+
+    return id;
+}
+
+/*!
+ * \brief Resolve a field ID, checking the field's own slot first
+ * \param clazz
+ * \param field
+ * \param is_static
+ * \param env
+ * \return
+ */
+inline ::jfieldID field_id(
+    ::jclass           clazz,
+    java::field const& field,
+    bool               is_static,
+    JNIEnv*            env = GetJNI())
+{
+    if(field.slot)
+        if(auto id = field.slot->find(clazz, field.signature, is_static))
+            return id;
+
+    auto id = field_id(
+        clazz, field.name.c_str(), field.signature.c_str(), is_static, env);
+
+    if(id && field.slot && classes().owns(clazz))
+        field.slot->store(clazz, field.signature, is_static, id);
+
+    return id;
+}
+
+} // namespace jnipp::cache
@@ -0,0 +1,63 @@
+#pragma once
+
+/* Checking levels, select one by defining JNIPP_CHECK_LEVEL.
+ *
+ * JNIPP_CHECK_FULL:    all checks, the default
+ * JNIPP_CHECK_DEBUG:   ID lookups are checked, type and bounds checks are
+ *                      only done when NDEBUG is not defined
+ * JNIPP_CHECK_TRUSTED: no checks, for proven call sites in release builds
+ *
+ * Java exceptions thrown by called methods are always checked, since
+ * leaving them pending breaks any following JNI call.
+ */
+#define JNIPP_CHECK_TRUSTED 0
+#define JNIPP_CHECK_DEBUG 1
+#define JNIPP_CHECK_FULL 2
+
+#ifndef JNIPP_CHECK_LEVEL
+#define JNIPP_CHECK_LEVEL JNIPP_CHECK_FULL
+#endif
+
+namespace jnipp::checks {
+
+enum class level
+{
+    trusted = JNIPP_CHECK_TRUSTED,
+    debug   = JNIPP_CHECK_DEBUG,
+    full    = JNIPP_CHECK_FULL,
+};
+
+constexpr level current = static_cast<level>(JNIPP_CHECK_LEVEL);
+
+#if defined(NDEBUG)
+constexpr bool debug_build = false;
+#else
+constexpr bool debug_build = true;
+#endif
+
+/*!
+ * \brief Check for exceptions after resolving method and field IDs
+ */
+constexpr bool lookups = current != level::trusted;
+
+/*!
+ * \brief Verify that objects are instances of the expected class before
+ * using them as such
+ */
+constexpr bool types =
+    current == level::full || (current == level::debug && debug_build);
+
+/*!
+ * \brief Check array indices against the array length
+ */
+constexpr bool bounds =
+    current == level::full || (current == level::debug && debug_build);
+
+/*!
+ * \brief Check for exceptions after the steps of a batch that cannot throw,
+ * eg. field reads and writes, instead of only at checkpoints. Steps that can
+ * throw are always checked.
+ */
+constexpr bool batch_steps = current == level::full;
+
+} // namespace jnipp::checks
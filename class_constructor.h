@@ -10,7 +10,7 @@ inline wrapping::jclass get_class(java::clazz const& clazz)
 
     class_name = type_signature::slashify(class_name);
 
-    return {GetJNI()->FindClass(class_name.c_str()), class_name};
+    return {cache::classes().resolve(class_name), class_name};
 }
 
 } // namespace jnipp
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "cache.h"
+#include "checks.h"
 #include "field_access.h"
 #include "jni_types.h"
 #include "method_calls.h"
@@ -20,7 +22,7 @@ struct jclass
 
     jclass(std::string const& clazz)
         : jclass(
-              GetJNI()->FindClass(type_signature::slashify(clazz).c_str()),
+              cache::classes().resolve(type_signature::slashify(clazz)),
               clazz)
     {
     }
@@ -34,18 +36,28 @@ struct jclass
      * \return
      */
     jobject construct(
-        jmethod<return_type::void_, Args...> const& method, Args... args);
+        jmethod<return_type::void_, Args...> const& method,
+        Args... args) const;
+
+    template<typename... Args>
+    /*!
+     * \brief Resolve a constructor once, to be called many times
+     * \param method
+     * \return
+     */
+    invocation::constructor_call<Args...> constructor(
+        jmethod<return_type::void_, Args...> const& method) const;
 
     /*!
      * \brief Object instantiation, wraps an existing object
      * \param instance
      * \return
      */
-    jobject operator()(java::object instance);
+    jobject operator()(java::object instance) const;
 
-    jobject operator()(::jobject instance);
+    jobject operator()(::jobject instance) const;
 
-    jobject operator()(java::value instance);
+    jobject operator()(java::value instance) const;
 
     template<return_type RType, typename... Args>
     /*!
@@ -54,17 +66,27 @@ struct jclass
      * \return
      */
     invocation::static_call<RType, Args...> operator[](
-        jmethod<RType, Args...> const& method)
+        jmethod<RType, Args...> const& method) const
     {
-        auto methodId = GetJNI()->GetStaticMethodID(
-            clazz, method.name(), method.signature());
+        auto methodId = cache::method_id(clazz, method.method, true);
 
-        invocation::call::check_exception();
+        if constexpr(checks::lookups)
+            invocation::call::check_exception();
+
+        /* The return class may fail to load too, eg. NoClassDefFoundError */
+        auto returns = cache::descriptors().clazz(method.method.return_class);
+
+        if constexpr(checks::lookups)
+            invocation::call::check_exception();
 
         return {
             java::static_method_reference({
                 clazz,
-                java::method(methodId, method.method.return_class),
+                {
+                    methodId,
+                    method.method.return_class,
+                    returns,
+                },
             }),
         };
     }
@@ -75,17 +97,17 @@ struct jclass
      * \param field
      * \return
      */
-    field_access::static_field<T> operator[](jfield<T> const& field)
+    field_access::static_field<T> operator[](jfield<T> const& field) const
     {
-        auto fieldId =
-            GetJNI()->GetStaticFieldID(clazz, field.name(), field.signature());
+        auto fieldId = cache::field_id(clazz, field.field, true);
 
-        invocation::call::check_exception();
+        if constexpr(checks::lookups)
+            invocation::call::check_exception();
 
         return {
             java::static_field_reference({
                 clazz,
-                java::field(fieldId, field.field.signature),
+                {fieldId},
             }),
         };
     }
@@ -116,30 +138,40 @@ struct jobject
 
     template<return_type RType, typename... Args>
     invocation::instance_call<RType, Args...> operator[](
-        jmethod<RType, Args...> const& method)
+        jmethod<RType, Args...> const& method) const
     {
-        auto methodId = GetJNI()->GetMethodID(
-            *object.clazz, method.name(), method.signature());
+        auto methodId = cache::method_id(object.clazz, method.method, false);
 
-        invocation::call::check_exception();
+        if constexpr(checks::lookups)
+            invocation::call::check_exception();
+
+        /* The return class may fail to load too, eg. NoClassDefFoundError */
+        auto returns = cache::descriptors().clazz(method.method.return_class);
+
+        if constexpr(checks::lookups)
+            invocation::call::check_exception();
 
         return {java::method_reference{
             object,
-            java::method(methodId, method.method.return_class),
+            {
+                methodId,
+                method.method.return_class,
+                returns,
+            },
         }};
     }
 
     template<return_type T>
-    field_access::instance_field<T> operator[](jfield<T> const& field)
+    field_access::instance_field<T> operator[](jfield<T> const& field) const
     {
-        auto fieldId = GetJNI()->GetFieldID(
-            *object.clazz, field.name(), field.signature());
+        auto fieldId = cache::field_id(object.clazz, field.field, false);
 
-        invocation::call::check_exception();
+        if constexpr(checks::lookups)
+            invocation::call::check_exception();
 
         return {java::field_reference{
             object,
-            java::field(fieldId, field.field.signature),
+            {fieldId},
         }};
     }
 
@@ -165,32 +197,39 @@ struct jobject
 
 template<typename... Args>
 inline jobject jclass::construct(
-    jmethod<return_type::void_, Args...> const& method, Args... args)
+    jmethod<return_type::void_, Args...> const& method, Args... args) const
 {
-    auto constructor =
-        GetJNI()->GetMethodID(clazz, method.name(), method.signature());
-
-    invocation::call::check_exception();
-
     return jobject{java::object{
-        {clazz},
-        *invocation::constructor_call({clazz, constructor})(args...),
+        clazz,
+        *constructor(method)(args...),
     }};
 }
 
-inline jobject jclass::operator()(java::object instance)
+template<typename... Args>
+inline invocation::constructor_call<Args...> jclass::constructor(
+    jmethod<return_type::void_, Args...> const& method) const
+{
+    auto constructor = cache::method_id(clazz, method.method, false);
+
+    if constexpr(checks::lookups)
+        invocation::call::check_exception();
+
+    return {java::static_method_reference{clazz, {constructor, 0, nullptr}}};
+}
+
+inline jobject jclass::operator()(java::object instance) const
 {
     return jobject(java::object{clazz, instance.instance});
 }
 
-inline jobject jclass::operator()(::jobject instance)
+inline jobject jclass::operator()(::jobject instance) const
 {
-    return (*this)(java::object({}, instance));
+    return (*this)(java::object(nullptr, instance));
 }
 
-inline jobject jclass::operator()(java::value instance)
+inline jobject jclass::operator()(java::value instance) const
 {
-    return (*this)(java::object({}, instance->l));
+    return (*this)(java::object(nullptr, instance->l));
 }
 
 } // namespace jnipp::wrapping
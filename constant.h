@@ -0,0 +1,119 @@
+#pragma once
+
+#include "class_wrapper.h"
+#include "field_access.h"
+#include "jni_types.h"
+#include "method_calls.h"
+#include "ref_accounting.h"
+#include "references.h"
+
+#include <type_traits>
+
+namespace jnipp {
+
+template<return_type T>
+/*!
+ * \brief A static field read once and kept in memory, for constants such as
+ * Integer.MAX_VALUE or Build.BOARD. Primitives are kept by value, and objects
+ * through a global reference. Non-final fields may be read again with
+ * refresh(), which must not run concurrently with reads of the same
+ * constant.
+ *
+ * Declaring one as a function-local static reads the field on first use:
+ *
+ *  static const jnipp::constant<return_type::int_> MAX_VALUE(
+ *      "java.lang.Integer"_jclass,
+ *      "MAX_VALUE"_jfield.as<return_type::int_>());
+ *
+ * Object constants delete their global reference when destroyed, which for
+ * a static happens at exit, possibly after the VM is gone. Those are better
+ * allocated and never destroyed, leaking the reference deliberately:
+ *
+ *  static auto const& BOARD = *new jnipp::constant<return_type::object_>(
+ *      "android.os.Build"_jclass,
+ *      "BOARD"_jfield.as("java.lang.String"));
+ */
+struct constant
+{
+    static_assert(
+        T != return_type::void_, "the field type must be set with as()");
+    static_assert(
+        stl_types::one_of(
+            T,
+            return_type::bool_,
+            return_type::byte_,
+            return_type::char_,
+            return_type::short_,
+            return_type::int_,
+            return_type::long_,
+            return_type::float_,
+            return_type::double_,
+            return_type::object_),
+        "constants are primitives or objects, arrays are not supported");
+
+    /*!
+     * \param clazz class declaring the field
+     * \param field static field, which is read right away
+     */
+    constant(wrapping::jclass const& clazz, wrapping::jfield<T> const& field)
+        : m_field(clazz[field])
+    {
+        refresh();
+    }
+
+    /*!
+     * \brief The value as of construction or the last refresh(). Objects are
+     * wrapped without a class, and stay valid as long as the constant.
+     * \return
+     */
+    auto operator*() const
+    {
+        if constexpr(is_object)
+            return wrapping::jobject(java::object{{}, m_value.get()});
+        else
+            return m_value;
+    }
+
+    /*!
+     * \brief Read the field again, throwing if its class fails to initialize
+     */
+    void refresh()
+    {
+        if constexpr(is_object)
+        {
+            auto env    = GetJNI();
+            auto local  = (*m_field).object.instance;
+            auto failed = env->ExceptionCheck() == JNI_TRUE;
+
+            if(!failed)
+                m_value = global_ref<>(local, env);
+
+            /* Released before throwing */
+            if constexpr(accounting::enabled)
+                accounting::local_released(local);
+            env->DeleteLocalRef(local);
+
+            if(failed)
+                invocation::call::check_exception();
+        } else
+        {
+            auto value = *m_field;
+            invocation::call::check_exception();
+
+            m_value = value;
+        }
+    }
+
+  private:
+    static constexpr bool is_object = T == return_type::object_;
+
+    field_access::static_field<T> m_field;
+
+    std::conditional_t<
+        is_object,
+        global_ref<>,
+        decltype(*std::declval<field_access::static_field<T>>())>
+        m_value;
+};
+
+} // namespace jnipp
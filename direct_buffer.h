@@ -0,0 +1,164 @@
+#pragma once
+
+#include "class_constructor.h"
+#include "class_wrapper.h"
+#include "errors.h"
+#include "method_call_impl.h"
+#include "references.h"
+
+#include <cstddef>
+#include <optional>
+#include <span>
+
+namespace jnipp::nio {
+
+template<typename T = std::byte>
+/*!
+ * \brief View of the memory behind a direct java.nio.ByteBuffer, such as a
+ * MappedByteBuffer. The buffer is kept alive through a global reference for
+ * as long as the view exists. Use a const T for read-only access.
+ */
+struct direct_buffer
+{
+    /*!
+     * \brief Wrap a direct buffer
+     * \param buffer any reference to the buffer
+     */
+    explicit direct_buffer(::jobject buffer)
+        : m_buffer(buffer)
+        , m_data(static_cast<T*>(GetJNI()->GetDirectBufferAddress(buffer)))
+        , m_size(
+              static_cast<size_t>(GetJNI()->GetDirectBufferCapacity(buffer)) /
+              sizeof(T))
+    {
+        if(!m_data)
+            throw java_type_cast_exception("not a direct buffer");
+    }
+
+    explicit direct_buffer(wrapping::jobject const& buffer)
+        : direct_buffer(buffer.object.instance)
+    {
+    }
+
+    T* data() const
+    {
+        return m_data;
+    }
+
+    size_t size() const
+    {
+        return m_size;
+    }
+
+    T* begin() const
+    {
+        return m_data;
+    }
+
+    T* end() const
+    {
+        return m_data + m_size;
+    }
+
+    std::span<T> span() const
+    {
+        return {m_data, m_size};
+    }
+
+    operator std::span<T>() const
+    {
+        return span();
+    }
+
+    ::jobject buffer() const
+    {
+        return m_buffer;
+    }
+
+  private:
+    global_ref<> m_buffer;
+    T*           m_data;
+    size_t       m_size;
+};
+
+using read_only_buffer  = direct_buffer<const std::byte>;
+using read_write_buffer = direct_buffer<std::byte>;
+
+enum class map_mode
+{
+    read_only,
+    read_write,
+};
+
+template<map_mode Mode>
+/*!
+ * \brief Memory-map a file through FileChannel.map(). The file and channel
+ * are closed again, the mapping stays valid while the buffer is alive.
+ * A single mapping is limited to 2 GiB by Java, map larger files in parts.
+ * \param path
+ * \param offset position in the file to map from
+ * \param size number of bytes to map, or -1 for the rest of the file
+ * \return
+ */
+inline auto map_file(std::string const& path, jlong offset = 0, jlong size = -1)
+{
+    using wrapping::jfield;
+    using wrapping::jmethod;
+
+    constexpr auto read_only = Mode == map_mode::read_only;
+
+    local_frame _(8);
+
+    auto RandomAccessFile = get_class({"java.io.RandomAccessFile"});
+    auto MapMode = get_class({"java.nio.channels.FileChannel$MapMode"});
+
+    auto init = jmethod<return_type::void_>({"<init>"})
+                    .arg<std::string>("java.lang.String")
+                    .arg<std::string>("java.lang.String");
+    auto getChannel = jmethod<return_type::void_>({"getChannel"})
+                          .ret("java.nio.channels.FileChannel");
+    auto channelSize =
+        jmethod<return_type::void_>({"size"}).ret<return_type::long_>();
+    auto map = jmethod<return_type::void_>({"map"})
+                   .ret("java.nio.MappedByteBuffer")
+                   .arg("java.nio.channels.FileChannel$MapMode")
+                   .arg<jlong>()
+                   .arg<jlong>();
+    auto close = jmethod<return_type::void_>({"close"});
+    auto mode  = jfield<return_type::void_>(
+                    {read_only ? "READ_ONLY" : "READ_WRITE"})
+                    .as("java.nio.channels.FileChannel$MapMode");
+
+    auto file = RandomAccessFile.construct(
+        init, path, std::string(read_only ? "r" : "rw"));
+
+    std::optional<wrapping::jobject> channel;
+
+    try
+    {
+        channel.emplace(file[getChannel]());
+
+        if(size < 0)
+            size = (*channel)[channelSize]() - offset;
+
+        auto buffer = (*channel)[map](*MapMode[mode], offset, size);
+
+        (*channel)[close]();
+        file[close]();
+
+        if constexpr(read_only)
+            return read_only_buffer(buffer);
+        else
+            return read_write_buffer(buffer);
+    } catch(...)
+    {
+        /* Closing twice is harmless, and errors from closing are dropped in
+         * favour of the one being rethrown */
+        if(channel)
+            (void)(*channel)[close].try_call();
+        (void)file[close].try_call();
+        throw;
+    }
+}
+
+} // namespace jnipp::nio
@@ -1,14 +1,295 @@
 #pragma once
 
+#include "cache.h"
 #include "jni_types.h"
+#include "references.h"
+#include "utf.h"
 
+#include <memory>
+#include <mutex>
 #include <stdexcept>
 
 namespace jnipp {
 
+namespace detail {
+
+/*!
+ * \brief Method IDs used to describe a Throwable, resolved once
+ */
+struct throwable_metadata
+{
+    static throwable_metadata const& get()
+    {
+        static const throwable_metadata metadata;
+        return metadata;
+    }
+
+    ::jmethodID getClass;
+    ::jmethodID getName;
+    ::jmethodID getMessage;
+    ::jmethodID getStackTrace;
+    ::jmethodID toString;
+
+  private:
+    throwable_metadata()
+    {
+        auto Object    = cache::classes().resolve("java/lang/Object");
+        auto Class     = cache::classes().resolve("java/lang/Class");
+        auto Throwable = cache::classes().resolve("java/lang/Throwable");
+
+        getClass =
+            cache::method_id(Object, "getClass", "()Ljava/lang/Class;", false);
+        getName =
+            cache::method_id(Class, "getName", "()Ljava/lang/String;", false);
+        getMessage = cache::method_id(
+            Throwable, "getMessage", "()Ljava/lang/String;", false);
+        getStackTrace = cache::method_id(
+            Throwable,
+            "getStackTrace",
+            "()[Ljava/lang/StackTraceElement;",
+            false);
+        toString =
+            cache::method_id(Object, "toString", "()Ljava/lang/String;", false);
+    }
+};
+
+/*!
+ * \brief Sets a pending exception aside for the lifetime of the scope, and
+ * throws it again on exit, so that Java can be called to describe another
+ * Throwable without losing the caller's exception
+ */
+struct pending_exception_scope
+{
+    pending_exception_scope()
+        : env(GetJNI())
+        , pending(env->ExceptionOccurred())
+    {
+        if(pending)
+            env->ExceptionClear();
+    }
+
+    ~pending_exception_scope()
+    {
+        if(!pending)
+            return;
+
+        env->ExceptionClear();
+        env->Throw(pending);
+        env->DeleteLocalRef(pending);
+    }
+
+    pending_exception_scope(pending_exception_scope const&) = delete;
+    pending_exception_scope& operator=(pending_exception_scope const&) =
+        delete;
+
+  private:
+    JNIEnv*      env;
+    ::jthrowable pending;
+};
+
+inline std::string throwable_string(::jobject instance, ::jmethodID method)
+{
+    detail::pending_exception_scope pending;
+
+    auto env = GetJNI();
+    auto str =
+        reinterpret_cast<jstring>(env->CallObjectMethod(instance, method));
+
+    std::string out;
+
+    if(env->ExceptionCheck() == JNI_TRUE)
+    {
+        env->ExceptionClear();
+        return out;
+    }
+
+    if(!str)
+        return out;
+
+    utf::from_java(str, out);
+    env->DeleteLocalRef(str);
+
+    return out;
+}
+
+} // namespace detail
+
+/*!
+ * \brief A Java exception, translated to C++. The type name, message and
+ * stack trace are only fetched from the Throwable when they are asked for,
+ * which keeps exceptions that are caught and discarded cheap.
+ */
 struct java_exception : std::runtime_error
 {
-    using runtime_error::runtime_error;
+    java_exception(std::string const& message)
+        : runtime_error(message)
+    {
+    }
+
+    /*!
+     * \brief Wrap a Throwable
+     * \param throwable any reference to the Throwable, a global reference
+     * is kept by the exception and its copies
+     */
+    java_exception(::jthrowable throwable)
+        : runtime_error("java exception")
+        , m_state(std::make_shared<state>(throwable))
+    {
+    }
+
+    const char* what() const noexcept override
+    {
+        if(!m_state)
+            return runtime_error::what();
+
+        std::call_once(m_state->what_flag, [this]() {
+            try
+            {
+                auto const& message = this->message();
+                m_state->what       = type_name();
+                if(!message.empty())
+                    m_state->what += ": " + message;
+            } catch(...)
+            {
+            }
+        });
+
+        return m_state->what.c_str();
+    }
+
+    /*!
+     * \brief Fully qualified class name of the Throwable
+     * \return
+     */
+    std::string const& type_name() const
+    {
+        if(!m_state)
+            return empty();
+
+        std::call_once(m_state->type_name_flag, [this]() {
+            detail::pending_exception_scope pending;
+
+            auto const& meta  = detail::throwable_metadata::get();
+            auto        env   = GetJNI();
+            auto        clazz = env->CallObjectMethod(
+                m_state->throwable, meta.getClass);
+
+            if(!clazz)
+            {
+                env->ExceptionClear();
+                return;
+            }
+
+            m_state->type_name = detail::throwable_string(clazz, meta.getName);
+
+            env->DeleteLocalRef(clazz);
+        });
+
+        return m_state->type_name;
+    }
+
+    /*!
+     * \brief Result of Throwable.getMessage(), empty if it is null
+     * \return
+     */
+    std::string const& message() const
+    {
+        if(!m_state)
+            return empty();
+
+        std::call_once(m_state->message_flag, [this]() {
+            detail::pending_exception_scope pending;
+
+            m_state->message = detail::throwable_string(
+                m_state->throwable,
+                detail::throwable_metadata::get().getMessage);
+        });
+
+        return m_state->message;
+    }
+
+    /*!
+     * \brief Stack trace of the Throwable, one frame per line
+     * \return
+     */
+    std::string const& stack_trace() const
+    {
+        if(!m_state)
+            return empty();
+
+        std::call_once(m_state->stack_trace_flag, [this]() {
+            detail::pending_exception_scope pending;
+
+            auto const& meta = detail::throwable_metadata::get();
+            auto        env  = GetJNI();
+            auto        frames =
+                reinterpret_cast<jobjectArray>(env->CallObjectMethod(
+                    m_state->throwable, meta.getStackTrace));
+
+            if(env->ExceptionCheck() == JNI_TRUE)
+            {
+                env->ExceptionClear();
+                return;
+            }
+
+            if(!frames)
+                return;
+
+            auto count = env->GetArrayLength(frames);
+
+            for(jsize i = 0; i < count; i++)
+            {
+                auto frame = env->GetObjectArrayElement(frames, i);
+                m_state->stack_trace +=
+                    "\tat " + detail::throwable_string(frame, meta.toString) +
+                    "\n";
+                env->DeleteLocalRef(frame);
+            }
+
+            env->DeleteLocalRef(frames);
+        });
+
+        return m_state->stack_trace;
+    }
+
+    /*!
+     * \brief The Throwable, or nullptr if the exception did not come from
+     * Java
+     * \return
+     */
+    ::jthrowable throwable() const
+    {
+        return m_state ? m_state->throwable.get() : nullptr;
+    }
+
+  private:
+    struct state
+    {
+        state(::jthrowable throwable)
+            : throwable(throwable)
+        {
+        }
+
+        global_ref<::jthrowable> throwable;
+
+        std::once_flag what_flag;
+        std::once_flag type_name_flag;
+        std::once_flag message_flag;
+        std::once_flag stack_trace_flag;
+
+        std::string what;
+        std::string type_name;
+        std::string message;
+        std::string stack_trace;
+    };
+
+    static std::string const& empty()
+    {
+        static const std::string none;
+        return none;
+    }
+
+    std::shared_ptr<state> m_state;
 };
 
 struct java_type_cast_exception : std::runtime_error
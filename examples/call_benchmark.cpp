@@ -0,0 +1,192 @@
+#include <jnipp.h>
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <utility>
+
+/* Cost of a static int method call with 0 to 8 int arguments, through
+ *
+ *  jni:    JNIEnv::CallStaticIntMethod, by hand
+ *  direct: call_no_except(), which forwards the arguments to the same entry
+ *          point when all of them are primitives or references
+ *  jvalue: the arguments packed into a jvalue array with get_args(), and
+ *          passed to CallStaticIntMethodA, which is what every call did
+ *          before
+ *
+ *  jnipp-call-benchmark [iterations]
+ */
+
+static JNIEnv* globalEnv;
+
+namespace jnipp {
+
+JNIEnv* GetJNI()
+{
+    return globalEnv;
+}
+
+} // namespace jnipp
+
+namespace {
+
+using jnipp::return_type;
+using jnipp::invocation::call::calling_method;
+
+/* Class file of jnipp.Bench, version 49, equivalent to:
+ *
+ *  package jnipp;
+ *
+ *  public final class Bench {
+ *      public static int f0() { return 0; }
+ *      public static int f1(int a) { return a; }
+ *      public static int f2(int a, int b) { return a + b; }
+ *      ...
+ *      public static int f8(int a, ..., int h) { return a + ... + h; }
+ *  }
+ */
+constexpr unsigned char bench_class[] = {
+    0xca, 0xfe, 0xba, 0xbe, 0x00, 0x00, 0x00, 0x31, 0x00, 0x18, 0x01, 0x00,
+    0x0b, 0x6a, 0x6e, 0x69, 0x70, 0x70, 0x2f, 0x42, 0x65, 0x6e, 0x63, 0x68,
+    0x07, 0x00, 0x01, 0x01, 0x00, 0x10, 0x6a, 0x61, 0x76, 0x61, 0x2f, 0x6c,
+    0x61, 0x6e, 0x67, 0x2f, 0x4f, 0x62, 0x6a, 0x65, 0x63, 0x74, 0x07, 0x00,
+    0x03, 0x01, 0x00, 0x04, 0x43, 0x6f, 0x64, 0x65, 0x01, 0x00, 0x02, 0x66,
+    0x30, 0x01, 0x00, 0x03, 0x28, 0x29, 0x49, 0x01, 0x00, 0x02, 0x66, 0x31,
+    0x01, 0x00, 0x04, 0x28, 0x49, 0x29, 0x49, 0x01, 0x00, 0x02, 0x66, 0x32,
+    0x01, 0x00, 0x05, 0x28, 0x49, 0x49, 0x29, 0x49, 0x01, 0x00, 0x02, 0x66,
+    0x33, 0x01, 0x00, 0x06, 0x28, 0x49, 0x49, 0x49, 0x29, 0x49, 0x01, 0x00,
+    0x02, 0x66, 0x34, 0x01, 0x00, 0x07, 0x28, 0x49, 0x49, 0x49, 0x49, 0x29,
+    0x49, 0x01, 0x00, 0x02, 0x66, 0x35, 0x01, 0x00, 0x08, 0x28, 0x49, 0x49,
+    0x49, 0x49, 0x49, 0x29, 0x49, 0x01, 0x00, 0x02, 0x66, 0x36, 0x01, 0x00,
+    0x09, 0x28, 0x49, 0x49, 0x49, 0x49, 0x49, 0x49, 0x29, 0x49, 0x01, 0x00,
+    0x02, 0x66, 0x37, 0x01, 0x00, 0x0a, 0x28, 0x49, 0x49, 0x49, 0x49, 0x49,
+    0x49, 0x49, 0x29, 0x49, 0x01, 0x00, 0x02, 0x66, 0x38, 0x01, 0x00, 0x0b,
+    0x28, 0x49, 0x49, 0x49, 0x49, 0x49, 0x49, 0x49, 0x49, 0x29, 0x49, 0x00,
+    0x31, 0x00, 0x02, 0x00, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x09, 0x00,
+    0x09, 0x00, 0x06, 0x00, 0x07, 0x00, 0x01, 0x00, 0x05, 0x00, 0x00, 0x00,
+    0x0e, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0xac, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x09, 0x00, 0x08, 0x00, 0x09, 0x00, 0x01, 0x00,
+    0x05, 0x00, 0x00, 0x00, 0x0e, 0x00, 0x01, 0x00, 0x01, 0x00, 0x00, 0x00,
+    0x02, 0x1a, 0xac, 0x00, 0x00, 0x00, 0x00, 0x00, 0x09, 0x00, 0x0a, 0x00,
+    0x0b, 0x00, 0x01, 0x00, 0x05, 0x00, 0x00, 0x00, 0x10, 0x00, 0x02, 0x00,
+    0x02, 0x00, 0x00, 0x00, 0x04, 0x1a, 0x1b, 0x60, 0xac, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x09, 0x00, 0x0c, 0x00, 0x0d, 0x00, 0x01, 0x00, 0x05, 0x00,
+    0x00, 0x00, 0x12, 0x00, 0x02, 0x00, 0x03, 0x00, 0x00, 0x00, 0x06, 0x1a,
+    0x1b, 0x60, 0x1c, 0x60, 0xac, 0x00, 0x00, 0x00, 0x00, 0x00, 0x09, 0x00,
+    0x0e, 0x00, 0x0f, 0x00, 0x01, 0x00, 0x05, 0x00, 0x00, 0x00, 0x14, 0x00,
+    0x02, 0x00, 0x04, 0x00, 0x00, 0x00, 0x08, 0x1a, 0x1b, 0x60, 0x1c, 0x60,
+    0x1d, 0x60, 0xac, 0x00, 0x00, 0x00, 0x00, 0x00, 0x09, 0x00, 0x10, 0x00,
+    0x11, 0x00, 0x01, 0x00, 0x05, 0x00, 0x00, 0x00, 0x17, 0x00, 0x02, 0x00,
+    0x05, 0x00, 0x00, 0x00, 0x0b, 0x1a, 0x1b, 0x60, 0x1c, 0x60, 0x1d, 0x60,
+    0x15, 0x04, 0x60, 0xac, 0x00, 0x00, 0x00, 0x00, 0x00, 0x09, 0x00, 0x12,
+    0x00, 0x13, 0x00, 0x01, 0x00, 0x05, 0x00, 0x00, 0x00, 0x1a, 0x00, 0x02,
+    0x00, 0x06, 0x00, 0x00, 0x00, 0x0e, 0x1a, 0x1b, 0x60, 0x1c, 0x60, 0x1d,
+    0x60, 0x15, 0x04, 0x60, 0x15, 0x05, 0x60, 0xac, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x09, 0x00, 0x14, 0x00, 0x15, 0x00, 0x01, 0x00, 0x05, 0x00, 0x00,
+    0x00, 0x1d, 0x00, 0x02, 0x00, 0x07, 0x00, 0x00, 0x00, 0x11, 0x1a, 0x1b,
+    0x60, 0x1c, 0x60, 0x1d, 0x60, 0x15, 0x04, 0x60, 0x15, 0x05, 0x60, 0x15,
+    0x06, 0x60, 0xac, 0x00, 0x00, 0x00, 0x00, 0x00, 0x09, 0x00, 0x16, 0x00,
+    0x17, 0x00, 0x01, 0x00, 0x05, 0x00, 0x00, 0x00, 0x20, 0x00, 0x02, 0x00,
+    0x08, 0x00, 0x00, 0x00, 0x14, 0x1a, 0x1b, 0x60, 0x1c, 0x60, 0x1d, 0x60,
+    0x15, 0x04, 0x60, 0x15, 0x05, 0x60, 0x15, 0x06, 0x60, 0x15, 0x07, 0x60,
+    0xac, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+};
+
+template<size_t>
+using int_arg = jint;
+
+using clock_type = std::chrono::steady_clock;
+
+template<typename Function>
+double time_per_call(long iterations, Function&& function)
+{
+    /* Warm up, so that the method is compiled */
+    for(long i = 0; i < iterations / 10; i++)
+        function(jint(i));
+
+    auto start = clock_type::now();
+
+    jint sink = 0;
+    for(long i = 0; i < iterations; i++)
+        sink += function(jint(i));
+
+    std::chrono::duration<double, std::nano> elapsed =
+        clock_type::now() - start;
+
+    if(sink == 42)
+        std::printf(" ");
+
+    return elapsed.count() / iterations;
+}
+
+template<size_t... I>
+void run(::jclass clazz, long iterations, std::index_sequence<I...>)
+{
+    constexpr auto arity = sizeof...(I);
+
+    jnipp::wrapping::jclass Bench(clazz, "jnipp.Bench");
+    jnipp::wrapping::jmethod<return_type::int_, int_arg<I>...> method(
+        jnipp::java::method{
+            "f" + std::to_string(arity),
+            "(" + std::string(arity, 'I') + ")I",
+        });
+
+    auto handle = Bench[method].method.method;
+    auto env    = jnipp::GetJNI();
+
+    auto jni = time_per_call(iterations, [&](jint value) {
+        return env->CallStaticIntMethod(
+            clazz, *handle, int_arg<I>(value + I)...);
+    });
+
+    auto direct = time_per_call(iterations, [&](jint value) {
+        return jnipp::invocation::call::
+            call_no_except<return_type::int_, calling_method::static_>(
+                clazz, nullptr, handle, int_arg<I>(value + I)...);
+    });
+
+    auto jvalue = time_per_call(iterations, [&](jint value) {
+        auto values = jnipp::invocation::arguments::get_args(
+            int_arg<I>(value + I)...);
+        return env->CallStaticIntMethodA(clazz, *handle, values.data());
+    });
+
+    std::printf("%6zu %10.1f %10.1f %10.1f\n", arity, jni, direct, jvalue);
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    long iterations = argc > 1 ? std::stol(argv[1]) : 1000000;
+
+    JavaVM* jvm = nullptr;
+
+    JavaVMInitArgs vm_args;
+    vm_args.version            = JNI_VERSION_1_6;
+    vm_args.nOptions           = 0;
+    vm_args.options            = nullptr;
+    vm_args.ignoreUnrecognized = false;
+
+    if(JNI_CreateJavaVM(&jvm, reinterpret_cast<void**>(&globalEnv), &vm_args) !=
+       JNI_OK)
+    {
+        std::fprintf(stderr, "failed to start the JVM\n");
+        return 1;
+    }
+
+    auto clazz = jnipp::cache::classes().define(
+        "jnipp/Bench", bench_class, sizeof(bench_class));
+    jnipp::invocation::call::check_exception();
+
+    std::printf(
+        "%6s %10s %10s %10s  (ns/call)\n", "arity", "jni", "direct", "jvalue");
+
+    [&]<size_t... N>(std::index_sequence<N...>) {
+        (run(clazz, iterations, std::make_index_sequence<N>()), ...);
+    }(std::make_index_sequence<9>());
+
+    jvm->DestroyJavaVM();
+
+    return 0;
+}
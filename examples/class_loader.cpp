@@ -0,0 +1,82 @@
+#include <jnipp.h>
+
+#include <cstdio>
+#include <string>
+#include <thread>
+
+/* Resolving application classes from a thread that native code attached
+ * itself. FindClass on such a thread only sees the system class loader, so
+ * the application's loader is captured in JNI_OnLoad, where FindClass still
+ * sees the application classes, and every later lookup goes through it.
+ *
+ * Built as a shared library, loaded by a class like:
+ *
+ *  package com.example;
+ *
+ *  public class Worker {
+ *      static { System.loadLibrary("jnipp-loader-example"); }
+ *
+ *      public static void report(String message) {
+ *          System.out.println(message);
+ *      }
+ *
+ *      public static native void start();
+ *  }
+ */
+
+static JavaVM* globalVM;
+
+namespace jnipp {
+
+JNIEnv* GetJNI()
+{
+    thread_local JNIEnv* env = nullptr;
+
+    if(!env &&
+       globalVM->GetEnv(reinterpret_cast<void**>(&env), JNI_VERSION_1_6) !=
+           JNI_OK)
+        globalVM->AttachCurrentThread(reinterpret_cast<void**>(&env), nullptr);
+
+    return env;
+}
+
+} // namespace jnipp
+
+extern "C" JNIEXPORT jint JNI_OnLoad(JavaVM* vm, void*)
+{
+    globalVM = vm;
+
+    auto env    = jnipp::GetJNI();
+    auto Worker = env->FindClass("com/example/Worker");
+
+    if(!Worker)
+        return JNI_ERR;
+
+    auto captured = jnipp::cache::classes().capture_class_loader(Worker, env);
+    env->DeleteLocalRef(Worker);
+
+    return captured ? JNI_VERSION_1_6 : JNI_ERR;
+}
+
+extern "C" JNIEXPORT void JNICALL Java_com_example_Worker_start(JNIEnv*, jclass)
+{
+    std::thread([]() {
+        using namespace jnipp::literals;
+
+        /* Attached by GetJNI(), with only the system class loader visible
+         * to FindClass. The class is found through the captured loader. */
+        try
+        {
+            auto const& Worker = "com.example.Worker"_jclass;
+            auto report =
+                "report"_jmethod.arg<std::string>("java.lang.String");
+
+            Worker[report](std::string("hello from a native thread"));
+        } catch(jnipp::java_exception const& e)
+        {
+            std::fprintf(stderr, "%s\n", e.what());
+        }
+
+        globalVM->DetachCurrentThread();
+    }).detach();
+}
@@ -0,0 +1,196 @@
+#include <jnipp.h>
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+
+#include <unistd.h>
+
+/* The class loader mode on desktop, with a java.net.URLClassLoader standing
+ * in for an application class loader. jnipp/Hidden is written to a
+ * directory that is not on the class path, so only the URLClassLoader over
+ * that directory can load it. The loader is passed to set_class_loader(),
+ * then a thread attached from native code shows that FindClass fails while
+ * get_class() and _jclass find the class.
+ *
+ *  jnipp-url-loader-example
+ */
+
+static JavaVM* globalVM;
+
+namespace jnipp {
+
+JNIEnv* GetJNI()
+{
+    thread_local JNIEnv* env = nullptr;
+
+    if(!env &&
+       globalVM->GetEnv(reinterpret_cast<void**>(&env), JNI_VERSION_1_6) !=
+           JNI_OK)
+        globalVM->AttachCurrentThread(reinterpret_cast<void**>(&env), nullptr);
+
+    return env;
+}
+
+} // namespace jnipp
+
+namespace {
+
+using jnipp::return_type;
+using jnipp::wrapping::jmethod;
+
+/* Class file of jnipp.Hidden, version 49, equivalent to:
+ *
+ *  package jnipp;
+ *
+ *  public final class Hidden {
+ *      public static String greeting() {
+ *          return "loaded through the URLClassLoader";
+ *      }
+ *  }
+ */
+constexpr unsigned char hidden_class[] = {
+    0xca, 0xfe, 0xba, 0xbe, 0x00, 0x00, 0x00, 0x31, 0x00, 0x0a, 0x01, 0x00,
+    0x0c, 0x6a, 0x6e, 0x69, 0x70, 0x70, 0x2f, 0x48, 0x69, 0x64, 0x64, 0x65,
+    0x6e, 0x07, 0x00, 0x01, 0x01, 0x00, 0x10, 0x6a, 0x61, 0x76, 0x61, 0x2f,
+    0x6c, 0x61, 0x6e, 0x67, 0x2f, 0x4f, 0x62, 0x6a, 0x65, 0x63, 0x74, 0x07,
+    0x00, 0x03, 0x01, 0x00, 0x04, 0x43, 0x6f, 0x64, 0x65, 0x01, 0x00, 0x21,
+    0x6c, 0x6f, 0x61, 0x64, 0x65, 0x64, 0x20, 0x74, 0x68, 0x72, 0x6f, 0x75,
+    0x67, 0x68, 0x20, 0x74, 0x68, 0x65, 0x20, 0x55, 0x52, 0x4c, 0x43, 0x6c,
+    0x61, 0x73, 0x73, 0x4c, 0x6f, 0x61, 0x64, 0x65, 0x72, 0x08, 0x00, 0x06,
+    0x01, 0x00, 0x08, 0x67, 0x72, 0x65, 0x65, 0x74, 0x69, 0x6e, 0x67, 0x01,
+    0x00, 0x14, 0x28, 0x29, 0x4c, 0x6a, 0x61, 0x76, 0x61, 0x2f, 0x6c, 0x61,
+    0x6e, 0x67, 0x2f, 0x53, 0x74, 0x72, 0x69, 0x6e, 0x67, 0x3b, 0x00, 0x31,
+    0x00, 0x02, 0x00, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x09,
+    0x00, 0x08, 0x00, 0x09, 0x00, 0x01, 0x00, 0x05, 0x00, 0x00, 0x00, 0x0f,
+    0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0x12, 0x07, 0xb0, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00,
+};
+
+/*!
+ * \brief Create a URLClassLoader over a directory
+ * \param directory
+ * \return a local reference to the loader
+ */
+jobject url_class_loader(std::string const& directory)
+{
+    auto env = jnipp::GetJNI();
+
+    auto File = jnipp::get_class({"java.io.File"});
+    auto init = jmethod<return_type::void_>({"<init>"})
+                    .arg<std::string>("java.lang.String");
+    auto toURI = jmethod<return_type::void_>({"toURI"}).ret("java.net.URI");
+    auto toURL = jmethod<return_type::void_>({"toURL"}).ret("java.net.URL");
+
+    auto uri = File.construct(init, directory)[toURI]();
+    auto url = uri[toURL]();
+
+    auto URL            = jnipp::get_class({"java.net.URL"});
+    auto URLClassLoader = jnipp::get_class({"java.net.URLClassLoader"});
+
+    auto urls = env->NewObjectArray(1, URL.clazz, url.object.instance);
+    jnipp::invocation::call::check_exception();
+
+    auto constructor =
+        env->GetMethodID(URLClassLoader.clazz, "<init>", "([Ljava/net/URL;)V");
+    jnipp::invocation::call::check_exception();
+
+    auto loader = env->NewObject(URLClassLoader.clazz, constructor, urls);
+    env->DeleteLocalRef(urls);
+    jnipp::invocation::call::check_exception();
+
+    return loader;
+}
+
+/*!
+ * \brief Look the class up from a thread attached by GetJNI()
+ * \return whether FindClass failed and the wrappers succeeded
+ */
+bool resolve_on_native_thread()
+{
+    using namespace jnipp::literals;
+
+    auto env = jnipp::GetJNI();
+
+    auto found = env->FindClass("jnipp/Hidden");
+    env->ExceptionClear();
+    std::printf("FindClass:        %s\n", found ? "found" : "not found");
+
+    bool ok = !found;
+
+    try
+    {
+        auto Hidden   = jnipp::get_class({"jnipp.Hidden"});
+        auto greeting = "greeting"_jmethod.ret("java.lang.String");
+
+        std::string message =
+            jnipp::java::type_unwrapper<std::string>(Hidden[greeting]().object);
+        std::printf("get_class:        %s\n", message.c_str());
+
+        auto const& literal = "jnipp.Hidden"_jclass;
+        std::printf(
+            "_jclass:          %s\n",
+            static_cast<::jclass>(literal.clazz) ? "found" : "not found");
+    } catch(jnipp::java_exception const& e)
+    {
+        std::fprintf(stderr, "%s\n", e.what());
+        ok = false;
+    }
+
+    globalVM->DetachCurrentThread();
+    return ok;
+}
+
+} // namespace
+
+int main()
+{
+    JNIEnv* env = nullptr;
+
+    JavaVMInitArgs vm_args;
+    vm_args.version            = JNI_VERSION_1_6;
+    vm_args.nOptions           = 0;
+    vm_args.options            = nullptr;
+    vm_args.ignoreUnrecognized = false;
+
+    if(JNI_CreateJavaVM(&globalVM, reinterpret_cast<void**>(&env), &vm_args) !=
+       JNI_OK)
+    {
+        std::fprintf(stderr, "failed to start the JVM\n");
+        return 1;
+    }
+
+    auto directory = std::filesystem::temp_directory_path() /
+                     ("jnipp-url-loader-" + std::to_string(::getpid()));
+    std::filesystem::create_directories(directory / "jnipp");
+
+    std::ofstream(directory / "jnipp" / "Hidden.class", std::ios::binary)
+        .write(
+            reinterpret_cast<const char*>(hidden_class), sizeof(hidden_class));
+
+    bool ok = false;
+
+    try
+    {
+        auto loader = url_class_loader(directory.string() + "/");
+
+        if(jnipp::cache::classes().set_class_loader(loader, env))
+        {
+            std::thread worker([&]() { ok = resolve_on_native_thread(); });
+            worker.join();
+        } else
+            jnipp::invocation::call::check_exception();
+
+        env->DeleteLocalRef(loader);
+    } catch(jnipp::java_exception const& e)
+    {
+        std::fprintf(stderr, "%s\n", e.what());
+    }
+
+    std::filesystem::remove_all(directory);
+    globalVM->DestroyJavaVM();
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,172 @@
+#pragma once
+
+#include "errors.h"
+#include "jni_types.h"
+
+#include <utility>
+#include <variant>
+
+namespace jnipp {
+
+/*!
+ * \brief Lightweight handle to a Java exception that was cleared instead of
+ * thrown. It owns a local reference to the Throwable, so it is only valid in
+ * the JNI frame it was created in.
+ */
+struct java_error
+{
+    explicit java_error(::jthrowable throwable)
+        : m_throwable(throwable)
+    {
+    }
+
+    java_error(java_error const&) = delete;
+
+    java_error(java_error&& other)
+        : m_throwable(std::exchange(other.m_throwable, nullptr))
+    {
+    }
+
+    java_error& operator=(java_error const&) = delete;
+
+    java_error& operator=(java_error&& other)
+    {
+        std::swap(m_throwable, other.m_throwable);
+        return *this;
+    }
+
+    ~java_error()
+    {
+        if(m_throwable)
+            GetJNI()->DeleteLocalRef(m_throwable);
+    }
+
+    ::jthrowable throwable() const
+    {
+        return m_throwable;
+    }
+
+    /*!
+     * \brief Translate to a C++ exception, which can outlive the frame
+     * \return
+     */
+    java_exception to_exception() const
+    {
+        return java_exception(m_throwable);
+    }
+
+    [[noreturn]] void rethrow() const
+    {
+        throw to_exception();
+    }
+
+  private:
+    ::jthrowable m_throwable;
+};
+
+template<typename T>
+/*!
+ * \brief Either the result of a call or the Java exception it threw
+ */
+struct expected
+{
+    expected(T value)
+        : m_value(std::in_place_index<0>, std::move(value))
+    {
+    }
+
+    expected(java_error&& error)
+        : m_value(std::in_place_index<1>, std::move(error))
+    {
+    }
+
+    bool has_value() const
+    {
+        return m_value.index() == 0;
+    }
+
+    explicit operator bool() const
+    {
+        return has_value();
+    }
+
+    /*!
+     * \brief Get the value, throwing the Java exception if there is none
+     * \return
+     */
+    T& value()
+    {
+        if(!has_value())
+            error().rethrow();
+        return std::get<0>(m_value);
+    }
+
+    T const& value() const
+    {
+        if(!has_value())
+            error().rethrow();
+        return std::get<0>(m_value);
+    }
+
+    T value_or(T fallback) const
+    {
+        return has_value() ? std::get<0>(m_value) : fallback;
+    }
+
+    T& operator*()
+    {
+        return std::get<0>(m_value);
+    }
+
+    T* operator->()
+    {
+        return &std::get<0>(m_value);
+    }
+
+    java_error const& error() const
+    {
+        return std::get<1>(m_value);
+    }
+
+  private:
+    std::variant<T, java_error> m_value;
+};
+
+template<>
+struct expected<void>
+{
+    expected()
+    {
+    }
+
+    expected(java_error&& error)
+        : m_error(std::move(error))
+    {
+    }
+
+    bool has_value() const
+    {
+        return !m_error.has_value();
+    }
+
+    explicit operator bool() const
+    {
+        return has_value();
+    }
+
+    void value() const
+    {
+        if(!has_value())
+            error().rethrow();
+    }
+
+    java_error const& error() const
+    {
+        return *m_error;
+    }
+
+  private:
+    optional<java_error> m_error;
+};
+
+} // namespace jnipp
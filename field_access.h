@@ -5,11 +5,52 @@
 
 namespace jnipp::field_access {
 
+namespace detail {
+
+template<return_type T>
+struct value_type
+{
+    using type = ::jobject;
+};
+
+#define DEFINE_FIELD_VALUE(JAVA_TYPE, RETURN_TYPE) \
+    template<>                                     \
+    struct value_type<RETURN_TYPE>                 \
+    {                                              \
+        using type = JAVA_TYPE;                    \
+    };
+
+DEFINE_FIELD_VALUE(::jboolean, return_type::bool_)
+DEFINE_FIELD_VALUE(::jbyte, return_type::byte_)
+DEFINE_FIELD_VALUE(::jchar, return_type::char_)
+DEFINE_FIELD_VALUE(::jshort, return_type::short_)
+DEFINE_FIELD_VALUE(::jint, return_type::int_)
+DEFINE_FIELD_VALUE(::jlong, return_type::long_)
+DEFINE_FIELD_VALUE(::jfloat, return_type::float_)
+DEFINE_FIELD_VALUE(::jdouble, return_type::double_)
+
+#undef DEFINE_FIELD_VALUE
+
+} // namespace detail
+
+template<return_type T>
+/*!
+ * \brief Type taken by a field setter, object fields take a plain reference
+ */
+using value_type_t = typename detail::value_type<T>::type;
+
 template<return_type T>
 struct instance_field
 {
     auto operator*() const;
 
+    /*!
+     * \brief Write the field. Like reads, writes are not checked for
+     * exceptions, since only the field lookup can fail.
+     * \param value
+     */
+    void set(value_type_t<T> value) const;
+
     java::field_reference field;
 };
 
@@ -18,6 +59,8 @@ struct static_field
 {
     auto operator*() const;
 
+    void set(value_type_t<T> value) const;
+
     java::static_field_reference field;
 };
 
@@ -33,15 +76,24 @@ struct jfield
     {
     }
 
+    /* Like jmethod, temporaries move the field along instead of copying */
+
     template<return_type T2>
     /*!
      * \brief define as POD or POD array type
      * \return
      */
-    jfield<T2> as()
+    jfield<T2> as() const&
     {
-        field.signature = type_signature::to_str<T2>();
-        return {std::move(field)};
+        return jfield(*this).template as<T2>();
+    }
+
+    template<return_type T2>
+    jfield<T2> as() &&
+    {
+        auto out      = std::move(field);
+        out.signature = type_signature::to_str<T2>();
+        return {std::move(out)};
     }
 
     /*!
@@ -49,11 +101,16 @@ struct jfield
      * \param type
      * \return
      */
-    jfield<return_type::object_> as(std::string const& type)
+    jfield<return_type::object_> as(std::string const& type) const&
+    {
+        return jfield(*this).as(type);
+    }
+
+    jfield<return_type::object_> as(std::string const& type) &&
     {
-        field.signature = type;
-        field.signature = "L" + type_signature::slashify(field.signature) + ";";
-        return {std::move(field)};
+        auto out      = std::move(field);
+        out.signature = "L" + type_signature::slashify(type) + ";";
+        return {std::move(out)};
     }
 
     template<return_type T2>
@@ -63,10 +120,18 @@ struct jfield
      * \param type class name for elements
      * \return
      */
-    jfield<T2> as(std::string const& type)
+    jfield<T2> as(std::string const& type) const&
+    {
+        return jfield(*this).template as<T2>(type);
+    }
+
+    template<return_type T2>
+    requires(T2 == return_type::object_array_)
+    jfield<T2> as(std::string const& type) &&
     {
-        field.signature = type_signature::to_str<T2>(type);
-        return {std::move(field)};
+        auto out      = std::move(field);
+        out.signature = type_signature::to_str<T2>(type);
+        return {std::move(out)};
     }
 
     const char* name() const
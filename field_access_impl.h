@@ -3,6 +3,7 @@
 #include "class_constructor.h"
 #include "class_wrapper.h"
 #include "field_access.h"
+#include "ref_accounting.h"
 
 namespace jnipp::field_access {
 
@@ -28,7 +29,9 @@ inline auto instance_field<T>::operator*() const
     else if constexpr(T == return_type::object_)
         return wrapping::jobject(java::object{
             {},
-            GetJNI()->GetObjectField(field.instance, *field.field),
+            accounting::track_local(
+                GetJNI()->GetObjectField(field.instance, *field.field),
+                *field.field),
         });
     else
         return java::value();
@@ -56,10 +59,58 @@ inline auto static_field<T>::operator*() const
     else if constexpr(T == return_type::object_)
         return wrapping::jobject(java::object{
             {},
-            GetJNI()->GetStaticObjectField(field.clazz, *field.field),
+            accounting::track_local(
+                GetJNI()->GetStaticObjectField(field.clazz, *field.field),
+                *field.field),
         });
     else
         return java::value();
 }
 
+template<return_type T>
+inline void instance_field<T>::set(value_type_t<T> value) const
+{
+    if constexpr(T == return_type::bool_)
+        GetJNI()->SetBooleanField(field.instance, *field.field, value);
+    else if constexpr(T == return_type::byte_)
+        GetJNI()->SetByteField(field.instance, *field.field, value);
+    else if constexpr(T == return_type::char_)
+        GetJNI()->SetCharField(field.instance, *field.field, value);
+    else if constexpr(T == return_type::short_)
+        GetJNI()->SetShortField(field.instance, *field.field, value);
+    else if constexpr(T == return_type::int_)
+        GetJNI()->SetIntField(field.instance, *field.field, value);
+    else if constexpr(T == return_type::long_)
+        GetJNI()->SetLongField(field.instance, *field.field, value);
+    else if constexpr(T == return_type::float_)
+        GetJNI()->SetFloatField(field.instance, *field.field, value);
+    else if constexpr(T == return_type::double_)
+        GetJNI()->SetDoubleField(field.instance, *field.field, value);
+    else
+        GetJNI()->SetObjectField(field.instance, *field.field, value);
+}
+
+template<return_type T>
+inline void static_field<T>::set(value_type_t<T> value) const
+{
+    if constexpr(T == return_type::bool_)
+        GetJNI()->SetStaticBooleanField(field.clazz, *field.field, value);
+    else if constexpr(T == return_type::byte_)
+        GetJNI()->SetStaticByteField(field.clazz, *field.field, value);
+    else if constexpr(T == return_type::char_)
+        GetJNI()->SetStaticCharField(field.clazz, *field.field, value);
+    else if constexpr(T == return_type::short_)
+        GetJNI()->SetStaticShortField(field.clazz, *field.field, value);
+    else if constexpr(T == return_type::int_)
+        GetJNI()->SetStaticIntField(field.clazz, *field.field, value);
+    else if constexpr(T == return_type::long_)
+        GetJNI()->SetStaticLongField(field.clazz, *field.field, value);
+    else if constexpr(T == return_type::float_)
+        GetJNI()->SetStaticFloatField(field.clazz, *field.field, value);
+    else if constexpr(T == return_type::double_)
+        GetJNI()->SetStaticDoubleField(field.clazz, *field.field, value);
+    else
+        GetJNI()->SetStaticObjectField(field.clazz, *field.field, value);
+}
+
 } // namespace jnipp::field_access
@@ -0,0 +1,293 @@
+#pragma once
+
+#include "cache.h"
+#include "checks.h"
+#include "class_wrapper.h"
+#include "field_access.h"
+#include "jni_types.h"
+#include "object_test.h"
+#include "ref_accounting.h"
+#include "references.h"
+#include "unwrappers.h"
+
+/* Bulk reads of primitive fields, gathered on the Java side. Reading n fields
+ * of m objects through JNI takes n * m transitions, here it is done with a
+ * single call into a helper class, which is defined from embedded bytes the
+ * first time it is needed. The result is a packed primitive array, which is
+ * read with the usual array extractors.
+ *
+ * DefineClass is not supported on Android, where the helper is unavailable.
+ */
+
+namespace jnipp::gather {
+
+namespace detail {
+
+/* Class file of jnipp.Gather, version 49 so that no stack map frames are
+ * needed. It was assembled by hand, and is equivalent to:
+ *
+ *  package jnipp;
+ *
+ *  public final class Gather {
+ *      public static int[] ints(Object[] objects, Field[] fields) {
+ *          int[] out = new int[objects.length * fields.length];
+ *          int   k   = 0;
+ *          for(int i = 0; i < objects.length; i++)
+ *              for(int j = 0; j < fields.length; j++)
+ *                  out[k++] = fields[j].getInt(objects[i]);
+ *          return out;
+ *      }
+ *
+ *      longs() and doubles() are the same, with getLong() and getDouble()
+ *  }
+ */
+inline constexpr unsigned char gather_class[] = {
+    0xca, 0xfe, 0xba, 0xbe, 0x00, 0x00, 0x00, 0x31, 0x00, 0x1a, 0x01, 0x00,
+    0x0c, 0x6a, 0x6e, 0x69, 0x70, 0x70, 0x2f, 0x47, 0x61, 0x74, 0x68, 0x65,
+    0x72, 0x07, 0x00, 0x01, 0x01, 0x00, 0x10, 0x6a, 0x61, 0x76, 0x61, 0x2f,
+    0x6c, 0x61, 0x6e, 0x67, 0x2f, 0x4f, 0x62, 0x6a, 0x65, 0x63, 0x74, 0x07,
+    0x00, 0x03, 0x01, 0x00, 0x04, 0x43, 0x6f, 0x64, 0x65, 0x01, 0x00, 0x17,
+    0x6a, 0x61, 0x76, 0x61, 0x2f, 0x6c, 0x61, 0x6e, 0x67, 0x2f, 0x72, 0x65,
+    0x66, 0x6c, 0x65, 0x63, 0x74, 0x2f, 0x46, 0x69, 0x65, 0x6c, 0x64, 0x07,
+    0x00, 0x06, 0x01, 0x00, 0x06, 0x67, 0x65, 0x74, 0x49, 0x6e, 0x74, 0x01,
+    0x00, 0x15, 0x28, 0x4c, 0x6a, 0x61, 0x76, 0x61, 0x2f, 0x6c, 0x61, 0x6e,
+    0x67, 0x2f, 0x4f, 0x62, 0x6a, 0x65, 0x63, 0x74, 0x3b, 0x29, 0x49, 0x0c,
+    0x00, 0x08, 0x00, 0x09, 0x0a, 0x00, 0x07, 0x00, 0x0a, 0x01, 0x00, 0x04,
+    0x69, 0x6e, 0x74, 0x73, 0x01, 0x00, 0x31, 0x28, 0x5b, 0x4c, 0x6a, 0x61,
+    0x76, 0x61, 0x2f, 0x6c, 0x61, 0x6e, 0x67, 0x2f, 0x4f, 0x62, 0x6a, 0x65,
+    0x63, 0x74, 0x3b, 0x5b, 0x4c, 0x6a, 0x61, 0x76, 0x61, 0x2f, 0x6c, 0x61,
+    0x6e, 0x67, 0x2f, 0x72, 0x65, 0x66, 0x6c, 0x65, 0x63, 0x74, 0x2f, 0x46,
+    0x69, 0x65, 0x6c, 0x64, 0x3b, 0x29, 0x5b, 0x49, 0x01, 0x00, 0x07, 0x67,
+    0x65, 0x74, 0x4c, 0x6f, 0x6e, 0x67, 0x01, 0x00, 0x15, 0x28, 0x4c, 0x6a,
+    0x61, 0x76, 0x61, 0x2f, 0x6c, 0x61, 0x6e, 0x67, 0x2f, 0x4f, 0x62, 0x6a,
+    0x65, 0x63, 0x74, 0x3b, 0x29, 0x4a, 0x0c, 0x00, 0x0e, 0x00, 0x0f, 0x0a,
+    0x00, 0x07, 0x00, 0x10, 0x01, 0x00, 0x05, 0x6c, 0x6f, 0x6e, 0x67, 0x73,
+    0x01, 0x00, 0x31, 0x28, 0x5b, 0x4c, 0x6a, 0x61, 0x76, 0x61, 0x2f, 0x6c,
+    0x61, 0x6e, 0x67, 0x2f, 0x4f, 0x62, 0x6a, 0x65, 0x63, 0x74, 0x3b, 0x5b,
+    0x4c, 0x6a, 0x61, 0x76, 0x61, 0x2f, 0x6c, 0x61, 0x6e, 0x67, 0x2f, 0x72,
+    0x65, 0x66, 0x6c, 0x65, 0x63, 0x74, 0x2f, 0x46, 0x69, 0x65, 0x6c, 0x64,
+    0x3b, 0x29, 0x5b, 0x4a, 0x01, 0x00, 0x09, 0x67, 0x65, 0x74, 0x44, 0x6f,
+    0x75, 0x62, 0x6c, 0x65, 0x01, 0x00, 0x15, 0x28, 0x4c, 0x6a, 0x61, 0x76,
+    0x61, 0x2f, 0x6c, 0x61, 0x6e, 0x67, 0x2f, 0x4f, 0x62, 0x6a, 0x65, 0x63,
+    0x74, 0x3b, 0x29, 0x44, 0x0c, 0x00, 0x14, 0x00, 0x15, 0x0a, 0x00, 0x07,
+    0x00, 0x16, 0x01, 0x00, 0x07, 0x64, 0x6f, 0x75, 0x62, 0x6c, 0x65, 0x73,
+    0x01, 0x00, 0x31, 0x28, 0x5b, 0x4c, 0x6a, 0x61, 0x76, 0x61, 0x2f, 0x6c,
+    0x61, 0x6e, 0x67, 0x2f, 0x4f, 0x62, 0x6a, 0x65, 0x63, 0x74, 0x3b, 0x5b,
+    0x4c, 0x6a, 0x61, 0x76, 0x61, 0x2f, 0x6c, 0x61, 0x6e, 0x67, 0x2f, 0x72,
+    0x65, 0x66, 0x6c, 0x65, 0x63, 0x74, 0x2f, 0x46, 0x69, 0x65, 0x6c, 0x64,
+    0x3b, 0x29, 0x5b, 0x44, 0x00, 0x31, 0x00, 0x02, 0x00, 0x04, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x03, 0x00, 0x09, 0x00, 0x0c, 0x00, 0x0d, 0x00, 0x01,
+    0x00, 0x05, 0x00, 0x00, 0x00, 0x49, 0x00, 0x06, 0x00, 0x06, 0x00, 0x00,
+    0x00, 0x3d, 0x2a, 0xbe, 0x2b, 0xbe, 0x68, 0xbc, 0x0a, 0x4d, 0x03, 0x3e,
+    0x03, 0x36, 0x04, 0x15, 0x04, 0x2a, 0xbe, 0xa2, 0x00, 0x2a, 0x03, 0x36,
+    0x05, 0x15, 0x05, 0x2b, 0xbe, 0xa2, 0x00, 0x1a, 0x2c, 0x1d, 0x2b, 0x15,
+    0x05, 0x32, 0x2a, 0x15, 0x04, 0x32, 0xb6, 0x00, 0x0b, 0x4f, 0x84, 0x03,
+    0x01, 0x84, 0x05, 0x01, 0xa7, 0xff, 0xe5, 0x84, 0x04, 0x01, 0xa7, 0xff,
+    0xd5, 0x2c, 0xb0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x09, 0x00, 0x12, 0x00,
+    0x13, 0x00, 0x01, 0x00, 0x05, 0x00, 0x00, 0x00, 0x49, 0x00, 0x06, 0x00,
+    0x06, 0x00, 0x00, 0x00, 0x3d, 0x2a, 0xbe, 0x2b, 0xbe, 0x68, 0xbc, 0x0b,
+    0x4d, 0x03, 0x3e, 0x03, 0x36, 0x04, 0x15, 0x04, 0x2a, 0xbe, 0xa2, 0x00,
+    0x2a, 0x03, 0x36, 0x05, 0x15, 0x05, 0x2b, 0xbe, 0xa2, 0x00, 0x1a, 0x2c,
+    0x1d, 0x2b, 0x15, 0x05, 0x32, 0x2a, 0x15, 0x04, 0x32, 0xb6, 0x00, 0x11,
+    0x50, 0x84, 0x03, 0x01, 0x84, 0x05, 0x01, 0xa7, 0xff, 0xe5, 0x84, 0x04,
+    0x01, 0xa7, 0xff, 0xd5, 0x2c, 0xb0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x09,
+    0x00, 0x18, 0x00, 0x19, 0x00, 0x01, 0x00, 0x05, 0x00, 0x00, 0x00, 0x49,
+    0x00, 0x06, 0x00, 0x06, 0x00, 0x00, 0x00, 0x3d, 0x2a, 0xbe, 0x2b, 0xbe,
+    0x68, 0xbc, 0x07, 0x4d, 0x03, 0x3e, 0x03, 0x36, 0x04, 0x15, 0x04, 0x2a,
+    0xbe, 0xa2, 0x00, 0x2a, 0x03, 0x36, 0x05, 0x15, 0x05, 0x2b, 0xbe, 0xa2,
+    0x00, 0x1a, 0x2c, 0x1d, 0x2b, 0x15, 0x05, 0x32, 0x2a, 0x15, 0x04, 0x32,
+    0xb6, 0x00, 0x17, 0x52, 0x84, 0x03, 0x01, 0x84, 0x05, 0x01, 0xa7, 0xff,
+    0xe5, 0x84, 0x04, 0x01, 0xa7, 0xff, 0xd5, 0x2c, 0xb0, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00,
+};
+
+/*!
+ * \brief The helper class and its methods, defined and resolved once
+ */
+struct gather_metadata
+{
+    static gather_metadata const& get()
+    {
+        static const gather_metadata metadata;
+        return metadata;
+    }
+
+    ::jclass    clazz;
+    ::jmethodID ints;
+    ::jmethodID longs;
+    ::jmethodID doubles;
+    ::jmethodID setAccessible;
+
+  private:
+    gather_metadata()
+    {
+        clazz = cache::classes().define(
+            "jnipp/Gather", gather_class, sizeof(gather_class));
+        invocation::call::check_exception();
+
+        ints = cache::method_id(
+            clazz,
+            "ints",
+            "([Ljava/lang/Object;[Ljava/lang/reflect/Field;)[I",
+            true);
+        longs = cache::method_id(
+            clazz,
+            "longs",
+            "([Ljava/lang/Object;[Ljava/lang/reflect/Field;)[J",
+            true);
+        doubles = cache::method_id(
+            clazz,
+            "doubles",
+            "([Ljava/lang/Object;[Ljava/lang/reflect/Field;)[D",
+            true);
+        setAccessible = cache::method_id(
+            cache::classes().resolve("java/lang/reflect/AccessibleObject"),
+            "setAccessible",
+            "(Z)V",
+            false);
+
+        invocation::call::check_exception();
+    }
+};
+
+} // namespace detail
+
+/*!
+ * \brief A set of instance fields of one class, reflected and made accessible
+ * once, to be gathered from many objects
+ */
+struct field_list
+{
+    template<return_type... Types>
+    /*!
+     * \param clazz class declaring the fields
+     * \param fields
+     */
+    field_list(
+        wrapping::jclass const& clazz, wrapping::jfield<Types> const&... fields)
+        : size(sizeof...(Types))
+    {
+        auto env = GetJNI();
+
+        local_frame _(2 * sizeof...(Types) + 4, env);
+
+        auto array = env->NewObjectArray(
+            size,
+            cache::classes().resolve("java/lang/reflect/Field", env),
+            nullptr);
+        invocation::call::check_exception();
+
+        jsize index = 0;
+        (add(array, clazz.clazz, fields.name(), fields.signature(), index++),
+         ...);
+
+        m_fields = global_ref<jobjectArray>(array, env);
+    }
+
+    jobjectArray fields() const
+    {
+        return m_fields;
+    }
+
+    jsize size;
+
+  private:
+    void add(
+        jobjectArray array,
+        ::jclass     clazz,
+        const char*  name,
+        const char*  signature,
+        jsize        index)
+    {
+        auto env = GetJNI();
+        auto id  = cache::field_id(clazz, name, signature, false, env);
+        invocation::call::check_exception();
+
+        auto reflected = env->ToReflectedField(clazz, id, JNI_FALSE);
+
+        if constexpr(accounting::enabled)
+            accounting::local_created(reflected, "<reflected field>");
+
+        env->CallVoidMethod(
+            reflected, detail::gather_metadata::get().setAccessible, JNI_TRUE);
+
+        if(env->ExceptionCheck() == JNI_FALSE)
+            env->SetObjectArrayElement(array, index, reflected);
+
+        if constexpr(accounting::enabled)
+            accounting::local_released(reflected);
+        env->DeleteLocalRef(reflected);
+
+        invocation::call::check_exception();
+    }
+
+    global_ref<jobjectArray> m_fields;
+};
+
+namespace detail {
+
+template<return_type T>
+inline java::array_type_unwrapper<T> gather(
+    ::jmethodID method, java::array const& objects, field_list const& fields)
+{
+    if constexpr(checks::types)
+        java::objects::verify_instance_of(
+            objects.instance, "[Ljava/lang/Object;");
+
+    auto result = GetJNI()->CallStaticObjectMethod(
+        gather_metadata::get().clazz,
+        method,
+        objects.instance,
+        fields.fields());
+    invocation::call::check_exception();
+
+    return java::array{
+        .instance    = reinterpret_cast<::jarray>(result),
+        .value_class = nullptr,
+        .value_type  = 0,
+    };
+}
+
+} // namespace detail
+
+/*!
+ * \brief Read int fields, or narrower ones, of every object
+ * \param objects array of objects, all instances of the fields' class
+ * \param fields
+ * \return int[] holding the fields of each object in turn, ie. element
+ * i * fields.size + j is field j of object i
+ */
+inline java::array_type_unwrapper<return_type::int_> ints(
+    java::array const& objects, field_list const& fields)
+{
+    return detail::gather<return_type::int_>(
+        detail::gather_metadata::get().ints, objects, fields);
+}
+
+/*!
+ * \brief Read long fields, or narrower integer ones, of every object
+ * \param objects
+ * \param fields
+ * \return long[] laid out like ints()
+ */
+inline java::array_type_unwrapper<return_type::long_> longs(
+    java::array const& objects, field_list const& fields)
+{
+    return detail::gather<return_type::long_>(
+        detail::gather_metadata::get().longs, objects, fields);
+}
+
+/*!
+ * \brief Read numeric fields of every object as doubles
+ * \param objects
+ * \param fields
+ * \return double[] laid out like ints()
+ */
+inline java::array_type_unwrapper<return_type::double_> doubles(
+    java::array const& objects, field_list const& fields)
+{
+    return detail::gather<return_type::double_>(
+        detail::gather_metadata::get().doubles, objects, fields);
+}
+
+} // namespace jnipp::gather
@@ -0,0 +1,244 @@
+#pragma once
+
+#include "cache.h"
+#include "class_wrapper.h"
+#include "jni_types.h"
+
+#include <algorithm>
+#include <unordered_map>
+#include <utility>
+
+namespace jnipp {
+
+namespace detail {
+
+/*!
+ * \brief System.identityHashCode, resolved once
+ */
+struct identity_metadata
+{
+    static identity_metadata const& get()
+    {
+        static const identity_metadata metadata;
+        return metadata;
+    }
+
+    jint hash(::jobject object, JNIEnv* env) const
+    {
+        return env->CallStaticIntMethod(System, identityHashCode, object);
+    }
+
+    ::jclass    System;
+    ::jmethodID identityHashCode;
+
+  private:
+    identity_metadata()
+    {
+        System           = cache::classes().resolve("java/lang/System");
+        identityHashCode = cache::method_id(
+            System, "identityHashCode", "(Ljava/lang/Object;)I", true);
+    }
+};
+
+} // namespace detail
+
+template<typename Value>
+/*!
+ * \brief Map from Java objects, compared by identity, to C++ values. Keys
+ * are held through weak global references, so the map does not keep them
+ * alive. Entries of collected objects are dropped when a lookup comes across
+ * them, when the map has doubled in size since it was last purged, or by
+ * calling purge().
+ *
+ * Every lookup makes one call to System.identityHashCode, plus one
+ * IsSameObject for each entry with the same hash. Like the standard
+ * containers, the map is not synchronized. It must be destroyed on a thread
+ * attached to the JVM.
+ */
+struct identity_map
+{
+    identity_map()
+    {
+    }
+
+    identity_map(identity_map const&) = delete;
+    identity_map& operator=(identity_map const&) = delete;
+
+    identity_map(identity_map&& other)
+        : m_entries(std::move(other.m_entries))
+        , m_purge_at(other.m_purge_at)
+    {
+        other.m_entries.clear();
+    }
+
+    ~identity_map()
+    {
+        clear();
+    }
+
+    /*!
+     * \brief Look up the value of an object
+     * \param key
+     * \return the value, or nullptr if the object has none
+     */
+    Value* find(wrapping::jobject const& key)
+    {
+        if(!key.object.instance)
+            return nullptr;
+
+        auto env = GetJNI();
+        auto it  = lookup(key.object.instance, hash(key, env), env);
+
+        return it != m_entries.end() ? &it->second.value : nullptr;
+    }
+
+    template<typename... Args>
+    /*!
+     * \brief Add a value for an object, unless it already has one
+     * \param key object, which must not be null
+     * \param args arguments for constructing the value
+     * \return the object's value, and whether it was inserted
+     */
+    std::pair<Value&, bool> try_emplace(
+        wrapping::jobject const& key, Args&&... args)
+    {
+        auto env  = GetJNI();
+        auto code = hash(key, env);
+
+        if(auto it = lookup(key.object.instance, code, env);
+           it != m_entries.end())
+            return {it->second.value, false};
+
+        if(m_entries.size() >= m_purge_at)
+            purge();
+
+        auto it = m_entries.emplace(
+            code, entry{nullptr, Value(std::forward<Args>(args)...)});
+
+        /* Created last, there is nothing left to throw and leak it */
+        it->second.key = env->NewWeakGlobalRef(key.object.instance);
+
+        return {it->second.value, true};
+    }
+
+    /*!
+     * \brief Value of an object, default-constructing it if there is none
+     * \param key
+     * \return
+     */
+    Value& operator[](wrapping::jobject const& key)
+    {
+        return try_emplace(key).first;
+    }
+
+    /*!
+     * \brief Remove the value of an object
+     * \param key
+     * \return whether the object had one
+     */
+    bool erase(wrapping::jobject const& key)
+    {
+        if(!key.object.instance)
+            return false;
+
+        auto env = GetJNI();
+        auto it  = lookup(key.object.instance, hash(key, env), env);
+
+        if(it == m_entries.end())
+            return false;
+
+        env->DeleteWeakGlobalRef(it->second.key);
+        m_entries.erase(it);
+        return true;
+    }
+
+    /*!
+     * \brief Drop the entries of all objects that have been collected
+     * \return number of entries dropped
+     */
+    size_t purge()
+    {
+        auto   env     = GetJNI();
+        size_t dropped = 0;
+
+        for(auto it = m_entries.begin(); it != m_entries.end();)
+        {
+            if(env->IsSameObject(it->second.key, nullptr) == JNI_TRUE)
+            {
+                env->DeleteWeakGlobalRef(it->second.key);
+                it = m_entries.erase(it);
+                dropped++;
+            } else
+                ++it;
+        }
+
+        m_purge_at = std::max<size_t>(initial_purge, 2 * m_entries.size());
+
+        return dropped;
+    }
+
+    void clear()
+    {
+        if(m_entries.empty())
+            return;
+
+        auto env = GetJNI();
+
+        for(auto& [_, entry] : m_entries)
+            env->DeleteWeakGlobalRef(entry.key);
+
+        m_entries.clear();
+    }
+
+    /*!
+     * \brief Number of entries, including those of collected objects that
+     * have not been purged yet
+     * \return
+     */
+    size_t size() const
+    {
+        return m_entries.size();
+    }
+
+  private:
+    struct entry
+    {
+        ::jweak key;
+        Value   value;
+    };
+
+    using entries = std::unordered_multimap<jint, entry>;
+
+    static constexpr size_t initial_purge = 64;
+
+    static jint hash(wrapping::jobject const& key, JNIEnv* env)
+    {
+        return detail::identity_metadata::get().hash(key.object.instance, env);
+    }
+
+    typename entries::iterator lookup(::jobject key, jint code, JNIEnv* env)
+    {
+        auto [it, end] = m_entries.equal_range(code);
+
+        while(it != end)
+        {
+            if(env->IsSameObject(it->second.key, key) == JNI_TRUE)
+                return it;
+
+            /* Same hash as a collected object, drop it while here */
+            if(env->IsSameObject(it->second.key, nullptr) == JNI_TRUE)
+            {
+                env->DeleteWeakGlobalRef(it->second.key);
+                it = m_entries.erase(it);
+            } else
+                ++it;
+        }
+
+        return m_entries.end();
+    }
+
+    entries m_entries;
+    size_t  m_purge_at = initial_purge;
+};
+
+} // namespace jnipp
@@ -4,8 +4,18 @@
 #define FORCEDINLINE inline
 #endif
 
+#include <cstdint>
 #include <jni.h>
+#include <optional>
 #include <string>
+#include <type_traits>
+
+namespace jnipp::cache {
+
+template<typename IdType>
+struct member_slot;
+
+} // namespace jnipp::cache
 
 namespace jnipp {
 
@@ -49,6 +59,12 @@ using optional = std::optional<T>;
 
 namespace java {
 
+/*!
+ * \brief Index of an interned class name or signature, see
+ * jnipp::cache::descriptors(). 0 is reserved for no descriptor.
+ */
+using descriptor = std::uint32_t;
+
 struct clazz
 {
     clazz(std::string const& name)
@@ -87,10 +103,18 @@ struct method
     {
     }
 
+    /*!
+     * \brief A method with a complete signature, eg. from generated bindings
+     * \param name
+     * \param signature
+     * \param return_class interned class name of returned objects
+     */
     method(
-        ::jmethodID           method_id,
-        optional<std::string> return_class = std::nullopt)
-        : method_id(method_id)
+        std::string const& name,
+        std::string const& signature,
+        descriptor         return_class = 0)
+        : name(name)
+        , signature(signature)
         , return_class(return_class)
     {
     }
@@ -124,15 +148,12 @@ struct method
         signature = begin + argType + end;
     }
 
-    ::jmethodID operator*() const
-    {
-        return *method_id;
-    }
+    std::string name;
+    std::string signature;
+    descriptor  return_class = 0;
 
-    std::string                name;
-    std::string                signature;
-    std::optional<std::string> return_class;
-    optional<::jmethodID>      method_id;
+    /* Per-site ID storage, set for methods created from literals */
+    cache::member_slot<::jmethodID>* slot = nullptr;
 };
 
 struct field
@@ -142,33 +163,54 @@ struct field
     {
     }
 
-    field(::jfieldID field_id, optional<std::string> field_class = std::nullopt)
-        : field_id(field_id)
-        , signature(field_class.value_or(std::string()))
-    {
-    }
-
     field& withType(std::string const& sig)
     {
         signature = sig;
         return *this;
     }
 
-    ::jfieldID operator*() const
+    std::string name;
+    std::string signature;
+
+    /* Per-site ID storage, set for fields created from literals */
+    cache::member_slot<::jfieldID>* slot = nullptr;
+};
+
+/*!
+ * \brief A resolved method, as used by the invocation layer. Unlike
+ * java::method, this is trivially copyable. For methods returning objects,
+ * the return class is resolved along with the method ID.
+ */
+struct method_handle
+{
+    ::jmethodID id;
+    descriptor  return_class;
+    ::jclass    return_clazz;
+
+    ::jmethodID operator*() const
     {
-        return *field_id;
+        return id;
     }
+};
 
-    std::string          name;
-    std::string          signature;
-    optional<::jfieldID> field_id;
+/*!
+ * \brief A resolved field, as used by the field accessors
+ */
+struct field_handle
+{
+    ::jfieldID id;
+
+    ::jfieldID operator*() const
+    {
+        return id;
+    }
 };
 
 struct array
 {
-    ::jarray    instance;
-    ::jclass    value_class;
-    std::string value_type;
+    ::jarray   instance;
+    ::jclass   value_class = nullptr;
+    descriptor value_type  = 0;
 
     operator ::jarray() const
     {
@@ -189,8 +231,8 @@ struct array
 
 struct object
 {
-    object(java::clazz clazz, ::jobject instance)
-        : clazz(*clazz.class_ref)
+    object(::jclass clazz, ::jobject instance)
+        : clazz(clazz)
         , instance(instance)
     {
     }
@@ -199,8 +241,8 @@ struct object
     {
     }
 
-    optional<::jclass> clazz;
-    ::jobject          instance;
+    ::jclass  clazz    = nullptr;
+    ::jobject instance = nullptr;
 
     operator ::jobject() const
     {
@@ -222,6 +264,26 @@ struct object
 
 using value = optional<::jvalue>;
 
+template<typename T>
+/*!
+ * \brief A boxed primitive, eg. boxed<jint> for java.lang.Integer, used as an
+ * argument type or with type_unwrapper
+ */
+struct boxed
+{
+    T value;
+};
+
+template<typename T>
+struct is_boxed : std::false_type
+{
+};
+
+template<typename T>
+struct is_boxed<boxed<T>> : std::true_type
+{
+};
+
 template<typename T>
 inline value make_value(T val)
 {
@@ -252,28 +314,34 @@ inline value make_value(T val)
 
 struct method_reference
 {
-    java::object instance;
-    java::method method;
+    java::object        instance;
+    java::method_handle method;
 };
 
 struct static_method_reference
 {
-    java::clazz  clazz;
-    java::method method;
+    ::jclass            clazz;
+    java::method_handle method;
 };
 
 struct field_reference
 {
-    java::object instance;
-    java::field  field;
+    java::object       instance;
+    java::field_handle field;
 };
 
 struct static_field_reference
 {
-    java::clazz clazz;
-    java::field field;
+    ::jclass           clazz;
+    java::field_handle field;
 };
 
+/* The references are passed by value on every call, keep them cheap */
+static_assert(std::is_trivially_copyable_v<method_reference>);
+static_assert(std::is_trivially_copyable_v<static_method_reference>);
+static_assert(std::is_trivially_copyable_v<field_reference>);
+static_assert(std::is_trivially_copyable_v<static_field_reference>);
+
 } // namespace java
 
 } // namespace jnipp
@@ -1,11 +1,25 @@
 #pragma once
 
 #include "arrays.h"
+#include "batch.h"
+#include "bound_method.h"
+#include "boxing.h"
+#include "constant.h"
+#include "direct_buffer.h"
 #include "errors.h"
+#include "expected.h"
 #include "field_access.h"
+#include "gather.h"
+#include "identity_map.h"
 #include "jni_types.h"
 #include "method_calls.h"
+#include "monitor.h"
+#include "native_peer.h"
+#include "ref_accounting.h"
+#include "references.h"
+#include "string_array.h"
 #include "unwrappers.h"
+#include "warmup.h"
 #include "wrappers.h"
 
 #include "class_cast_impl.h"
@@ -20,22 +34,89 @@
 
 namespace jnipp::literals {
 
-FORCEDINLINE jnipp::wrapping::jclass operator""_jclass(
-    const char* name, size_t)
+namespace detail {
+
+template<size_t N>
+/*!
+ * \brief A string literal as a template argument, which gives every literal
+ * its own instantiation of the operators below, and with it its own storage
+ */
+struct fixed_string
+{
+    constexpr fixed_string(const char (&str)[N])
+    {
+        std::copy_n(str, N, value);
+    }
+
+    char value[N];
+};
+
+} // namespace detail
+
+template<detail::fixed_string Name>
+/*!
+ * \brief The class is resolved the first time the literal is evaluated, and
+ * kept for the lifetime of the program. If resolving it fails, it throws at
+ * every check level, and the next evaluation tries again.
+ * \return
+ */
+FORCEDINLINE jnipp::wrapping::jclass const& operator""_jclass()
 {
-    return jnipp::get_class({name});
+    static const jnipp::wrapping::jclass clazz = []() {
+        auto out = jnipp::get_class({Name.value});
+
+        if(!static_cast<::jclass>(out.clazz))
+        {
+            invocation::call::check_exception();
+            throw std::runtime_error("class not found: " + out.class_name);
+        }
+
+        return out;
+    }();
+
+    return clazz;
 }
 
-FORCEDINLINE jnipp::wrapping::jmethod<jnipp::return_type::void_>
-operator""_jmethod(const char* name, size_t)
+template<detail::fixed_string Name>
+/*!
+ * \brief Methods declared from the literal share an ID slot, which keeps the
+ * ID for each class and signature they are resolved for, up to
+ * member_slot::capacity of them
+ * \return
+ */
+FORCEDINLINE jnipp::wrapping::jmethod<jnipp::return_type::void_> const&
+operator""_jmethod()
 {
-    return {jnipp::java::method{name}};
+    static cache::member_slot<::jmethodID> slot;
+    static const jnipp::wrapping::jmethod<jnipp::return_type::void_> method =
+        []() {
+            java::method out{Name.value};
+            out.slot = &slot;
+            return jnipp::wrapping::jmethod<jnipp::return_type::void_>(
+                std::move(out));
+        }();
+
+    return method;
 }
 
-FORCEDINLINE jnipp::wrapping::jfield<jnipp::return_type::void_>
-operator""_jfield(const char* name, size_t)
+template<detail::fixed_string Name>
+/*!
+ * \brief Fields declared from the literal share an ID slot, like _jmethod
+ * \return
+ */
+FORCEDINLINE jnipp::wrapping::jfield<jnipp::return_type::void_> const&
+operator""_jfield()
 {
-    return {jnipp::java::field{name}};
+    static cache::member_slot<::jfieldID> slot;
+    static const jnipp::wrapping::jfield<jnipp::return_type::void_> field =
+        []() {
+            java::field out{Name.value};
+            out.slot = &slot;
+            return jnipp::wrapping::jfield<jnipp::return_type::void_>(
+                std::move(out));
+        }();
+
+    return field;
 }
 
 } // namespace jnipp::literals
@@ -44,24 +125,13 @@ inline void jnipp::invocation::call::check_exception()
 {
     if(GetJNI()->ExceptionCheck() == JNI_TRUE)
     {
-        exception_clear_scope _;
-
-        auto exception = java::object({}, GetJNI()->ExceptionOccurred());
+        auto throwable = GetJNI()->ExceptionOccurred();
 
         GetJNI()->ExceptionClear();
 
-        auto exceptionType =
-            get_class_name(java::object(java::clazz{}, exception));
-
-        auto Throwable = get_class(java::clazz{"java.lang.Throwable"});
-        auto getMessage =
-            wrapping::jmethod<return_type::void_>(java::method("getMessage"))
-                .ret("java.lang.String");
-
-        auto message = java::type_unwrapper<std::string>(
-            Throwable(exception)[getMessage]());
+        java_exception exception(throwable);
+        GetJNI()->DeleteLocalRef(throwable);
 
-        throw java_exception(
-            exceptionType + ": " + static_cast<std::string>(message));
+        throw exception;
     }
 }
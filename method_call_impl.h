@@ -2,6 +2,7 @@
 
 #include "class_constructor.h"
 #include "class_wrapper.h"
+#include "expected.h"
 #include "unwrappers.h"
 
 namespace jnipp::invocation::call {
@@ -26,38 +27,56 @@ constexpr return_type array_type_to_value_type(return_type t)
     }
 }
 
+/*!
+ * \brief Get the class of returned objects, which is normally resolved
+ * when the method is bound, and otherwise looked up here
+ */
+inline ::jclass return_class(java::method_handle const& method)
+{
+    if(method.return_clazz)
+        return method.return_clazz;
+
+    if(!method.return_class)
+        throw std::runtime_error("no return class provided");
+
+    auto clazz = cache::descriptors().clazz(method.return_class);
+    check_exception();
+    return clazz;
+}
+
+/*!
+ * \brief Same as return_class(), but a failed lookup is left pending as a
+ * Java exception and nullptr is returned
+ */
+inline ::jclass try_return_class(java::method_handle const& method)
+{
+    if(method.return_clazz || !method.return_class)
+        return method.return_clazz;
+
+    return cache::descriptors().clazz(method.return_class);
+}
+
 } // namespace
 
-template<return_type Type, calling_method Calling, typename... Args>
-inline auto call(
-    java::clazz clazz, java::object obj, java::method method, Args... args)
+/*!
+ * \brief Convert the raw result of call_no_except() to the type returned to
+ * the caller
+ * \param out
+ * \param method
+ * \return
+ */
+template<return_type Type, typename Result>
+inline auto translate_result(Result out, java::method_handle const& method)
 {
-    if constexpr(Type == return_type::void_)
-    {
-        call_no_except<Type, Calling>(
-            clazz, obj, method, std::forward<Args>(args)...);
-        check_exception();
-    } else if constexpr(Type == return_type::object_)
+    if constexpr(Type == return_type::object_)
     {
-        auto out = call_no_except<Type, Calling>(
-            clazz, obj, method, std::forward<Args>(args)...);
-        check_exception();
-        if(!method.return_class.has_value())
-            throw std::runtime_error("no return class provided");
-        auto output_class = get_class(java::clazz(*method.return_class));
-        return output_class(out);
+        return wrapping::jobject(java::object{return_class(method), out});
     } else if constexpr(Type == return_type::object_array_)
     {
-        auto out = call_no_except<Type, Calling>(
-            clazz, obj, method, std::forward<Args>(args)...);
-        check_exception();
-        if(!method.return_class.has_value())
-            throw std::runtime_error("no return class provided");
-        auto output_class = get_class(java::clazz(*method.return_class));
         return java::array_type_unwrapper<return_type::object_>(java::array{
             .instance    = *out.array(),
-            .value_class = output_class.clazz,
-            .value_type  = *method.return_class,
+            .value_class = return_class(method),
+            .value_type  = method.return_class,
         });
     } else if constexpr(
         Type == return_type::bool_array_ || Type == return_type::byte_array_ ||
@@ -65,19 +84,96 @@ inline auto call(
         Type == return_type::int_array_ || Type == return_type::long_array_ ||
         Type == return_type::float_array_ || Type == return_type::double_array_)
     {
-        auto out = call_no_except<Type, Calling>(
-            clazz, obj, method, std::forward<Args>(args)...);
-        check_exception();
         return java::array_type_unwrapper<array_type_to_value_type(Type)>(
             java::array{
                 .instance = out,
             });
-    } else if constexpr(Type != return_type::void_)
+    } else
+        return out;
+}
+
+/*!
+ * \brief Take the pending Java exception, if any, and clear it
+ * \return
+ */
+inline optional<java_error> take_exception()
+{
+    if(GetJNI()->ExceptionCheck() == JNI_FALSE)
+        return std::nullopt;
+
+    auto throwable = GetJNI()->ExceptionOccurred();
+    GetJNI()->ExceptionClear();
+    return java_error(throwable);
+}
+
+template<return_type Type, calling_method Calling, typename... Args>
+inline auto call(
+    ::jclass            clazz,
+    ::jobject           obj,
+    java::method_handle method,
+    Args... args)
+{
+    if constexpr(Type == return_type::void_)
+    {
+        call_no_except<Type, Calling>(
+            clazz, obj, method, std::forward<Args>(args)...);
+        check_exception();
+    } else
     {
         auto out = call_no_except<Type, Calling>(
             clazz, obj, method, std::forward<Args>(args)...);
         check_exception();
-        return out;
+        return translate_result<Type>(out, method);
+    }
+}
+
+template<return_type Type, calling_method Calling, typename... Args>
+inline auto try_call(
+    ::jclass            clazz,
+    ::jobject           obj,
+    java::method_handle method,
+    Args... args)
+{
+    if constexpr(Type == return_type::void_)
+    {
+        call_no_except<Type, Calling>(
+            clazz, obj, method, std::forward<Args>(args)...);
+
+        if(auto error = take_exception())
+            return expected<void>(std::move(*error));
+        return expected<void>();
+    } else
+    {
+        auto out = call_no_except<Type, Calling>(
+            clazz, obj, method, std::forward<Args>(args)...);
+
+        using result_type = decltype(translate_result<Type>(out, method));
+
+        if(auto error = take_exception())
+            return expected<result_type>(std::move(*error));
+
+        if constexpr(
+            Type == return_type::object_ || Type == return_type::object_array_)
+        {
+            /* Resolved here so that translate_result() cannot throw */
+            method.return_clazz = try_return_class(method);
+
+            if(!method.return_clazz)
+            {
+                if(out.instance)
+                {
+                    if constexpr(accounting::enabled)
+                        accounting::local_released(out.instance);
+                    GetJNI()->DeleteLocalRef(out.instance);
+                }
+
+                if(auto error = take_exception())
+                    return expected<result_type>(std::move(*error));
+                throw std::runtime_error("no return class provided");
+            }
+        }
+
+        return expected<result_type>(translate_result<Type>(out, method));
     }
 }
 
@@ -1,7 +1,9 @@
 #pragma once
 
+#include "cache.h"
 #include "jni_types.h"
 #include "object_test.h"
+#include "ref_accounting.h"
 #include "type_signatures.h"
 #include "wrappers.h"
 
@@ -29,7 +31,7 @@ template<typename T>
 requires std::is_same_v<T, java::object>
 inline void get_arg_value(std::vector<jvalue>& values, T arg1)
 {
-    values.push_back(arg1.instance);
+    values.push_back(jvalue{.l = arg1.instance});
 }
 
 template<typename T>
@@ -40,6 +42,29 @@ inline void get_arg_value(std::vector<jvalue>& values, T arg1)
     values.push_back(wrapper);
 }
 
+template<typename T>
+/*!
+ * \brief Whether an argument can be passed to the variadic Call*Method
+ * entry points as it is, which holds for JNI primitives and references
+ */
+constexpr bool is_direct =
+    std::is_same_v<T, jboolean> || std::is_same_v<T, jbyte> ||
+    std::is_same_v<T, jchar> || std::is_same_v<T, jshort> ||
+    std::is_same_v<T, jint> || std::is_same_v<T, jlong> ||
+    std::is_same_v<T, jfloat> || std::is_same_v<T, jdouble> ||
+    std::is_same_v<T, java::object> ||
+    (std::is_pointer_v<T> && std::is_convertible_v<T, ::jobject>);
+
+template<typename T>
+requires is_direct<T>
+inline auto direct(T arg)
+{
+    if constexpr(std::is_same_v<T, java::object>)
+        return arg.instance;
+    else
+        return arg;
+}
+
 template<typename... Args>
 inline std::vector<jvalue> get_args(Args... args)
 {
@@ -61,74 +86,124 @@ enum class calling_method
 
 void check_exception();
 
+namespace detail {
+
+template<return_type Type>
+/*!
+ * \brief The JNI entry points for calling a method with a return type, in
+ * the variadic form taking the arguments directly, and the A form taking a
+ * jvalue array
+ */
+struct jni_call;
+
+#define DEFINE_JNI_CALL(RETURN_TYPE, JAVA_NAME)                                \
+    template<>                                                                 \
+    struct jni_call<RETURN_TYPE>                                               \
+    {                                                                          \
+        template<typename... Args>                                             \
+        static auto instance(                                                  \
+            JNIEnv* env, ::jobject object, ::jmethodID method, Args... args)   \
+        {                                                                      \
+            return env->Call##JAVA_NAME##Method(object, method, args...);      \
+        }                                                                      \
+        template<typename... Args>                                             \
+        static auto static_(                                                   \
+            JNIEnv* env, ::jclass clazz, ::jmethodID method, Args... args)     \
+        {                                                                      \
+            return env->CallStatic##JAVA_NAME##Method(clazz, method, args...); \
+        }                                                                      \
+        static auto instance_a(                                                \
+            JNIEnv*       env,                                                 \
+            ::jobject     object,                                              \
+            ::jmethodID   method,                                              \
+            jvalue const* values)                                              \
+        {                                                                      \
+            return env->Call##JAVA_NAME##MethodA(object, method, values);      \
+        }                                                                      \
+        static auto static_a(                                                  \
+            JNIEnv*       env,                                                 \
+            ::jclass      clazz,                                               \
+            ::jmethodID   method,                                              \
+            jvalue const* values)                                              \
+        {                                                                      \
+            return env->CallStatic##JAVA_NAME##MethodA(clazz, method, values); \
+        }                                                                      \
+    };
+
+DEFINE_JNI_CALL(return_type::bool_, Boolean)
+DEFINE_JNI_CALL(return_type::byte_, Byte)
+DEFINE_JNI_CALL(return_type::char_, Char)
+DEFINE_JNI_CALL(return_type::short_, Short)
+DEFINE_JNI_CALL(return_type::int_, Int)
+DEFINE_JNI_CALL(return_type::long_, Long)
+DEFINE_JNI_CALL(return_type::float_, Float)
+DEFINE_JNI_CALL(return_type::double_, Double)
+DEFINE_JNI_CALL(return_type::object_, Object)
+DEFINE_JNI_CALL(return_type::void_, Void)
+
+#undef DEFINE_JNI_CALL
+
+/* Arrays of any kind are returned as objects */
+template<return_type Type>
+struct jni_call : jni_call<return_type::object_>
+{
+};
+
 template<return_type Type, calling_method Calling, typename... Args>
-inline auto call_no_except(
-    java::clazz clazz, java::object object, java::method method, Args... args)
+/*!
+ * \brief Call a method, passing the arguments straight to the variadic entry
+ * point if they all allow it, and through a jvalue array otherwise
+ */
+inline auto invoke(
+    ::jclass            clazz,
+    ::jobject           object,
+    java::method_handle method,
+    Args... args)
 {
-    auto values = arguments::get_args(std::forward<Args>(args)...);
+    using entry = jni_call<Type>;
 
-    if constexpr(Type == return_type::bool_)
-    {
-        return Calling == calling_method::static_
-                   ? GetJNI()->CallStaticBooleanMethodA(
-                         clazz, *method, values.data())
-                   : GetJNI()->CallBooleanMethodA(
-                         object, *method, values.data());
-    } else if constexpr(Type == return_type::byte_)
-    {
-        return Calling == calling_method::static_
-                   ? GetJNI()->CallStaticByteMethodA(
-                         clazz, *method, values.data())
-                   : GetJNI()->CallByteMethodA(object, *method, values.data());
-    } else if constexpr(Type == return_type::char_)
-    {
-        return Calling == calling_method::static_
-                   ? GetJNI()->CallStaticCharMethodA(
-                         clazz, *method, values.data())
-                   : GetJNI()->CallCharMethodA(object, *method, values.data());
-    } else if constexpr(Type == return_type::short_)
-    {
-        return Calling == calling_method::static_
-                   ? GetJNI()->CallStaticShortMethodA(
-                         clazz, *method, values.data())
-                   : GetJNI()->CallShortMethodA(object, *method, values.data());
-    } else if constexpr(Type == return_type::int_)
-    {
-        return Calling == calling_method::static_
-                   ? GetJNI()->CallStaticIntMethodA(
-                         clazz, *method, values.data())
-                   : GetJNI()->CallIntMethodA(object, *method, values.data());
-    } else if constexpr(Type == return_type::long_)
-    {
-        return Calling == calling_method::static_
-                   ? GetJNI()->CallStaticLongMethodA(
-                         clazz, *method, values.data())
-                   : GetJNI()->CallLongMethodA(object, *method, values.data());
-    } else if constexpr(Type == return_type::float_)
+    auto env = GetJNI();
+
+    if constexpr((arguments::is_direct<Args> && ...))
     {
-        return Calling == calling_method::static_
-                   ? GetJNI()->CallStaticFloatMethodA(
-                         clazz, *method, values.data())
-                   : GetJNI()->CallFloatMethodA(object, *method, values.data());
-    } else if constexpr(Type == return_type::double_)
+        if constexpr(Calling == calling_method::static_)
+            return entry::static_(
+                env, clazz, *method, arguments::direct(args)...);
+        else
+            return entry::instance(
+                env, object, *method, arguments::direct(args)...);
+    } else
     {
-        return Calling == calling_method::static_
-                   ? GetJNI()->CallStaticDoubleMethodA(
-                         clazz, *method, values.data())
-                   : GetJNI()->CallDoubleMethodA(
-                         object, *method, values.data());
-    } else if constexpr(
+        auto values = arguments::get_args(args...);
+
+        if constexpr(Calling == calling_method::static_)
+            return entry::static_a(env, clazz, *method, values.data());
+        else
+            return entry::instance_a(env, object, *method, values.data());
+    }
+}
+
+} // namespace detail
+
+template<return_type Type, calling_method Calling, typename... Args>
+inline auto call_no_except(
+    ::jclass            clazz,
+    ::jobject           object,
+    java::method_handle method,
+    Args... args)
+{
+    if constexpr(
         Type == return_type::object_ || Type == return_type::object_array_)
     {
         return java::object{
-            java::clazz(nullptr),
-            Calling == calling_method::static_
-                ? GetJNI()->CallStaticObjectMethodA(
-                      clazz, *method, values.data())
-                : GetJNI()->CallObjectMethodA(object, *method, values.data())};
+            nullptr,
+            accounting::track_local(
+                detail::invoke<Type, Calling>(clazz, object, method, args...),
+                *method)};
     } else if constexpr(stl_types::one_of(
                             Type,
                             return_type::bool_array_,
+                            return_type::byte_array_,
                             return_type::char_array_,
                             return_type::short_array_,
                             return_type::int_array_,
@@ -137,25 +212,36 @@ inline auto call_no_except(
                             return_type::double_array_))
     {
         return java::object{
-            java::clazz(nullptr),
-            Calling == calling_method::static_
-                ? GetJNI()->CallStaticObjectMethodA(
-                      clazz, *method, values.data())
-                : GetJNI()->CallObjectMethodA(object, *method, values.data())}
+            nullptr,
+            accounting::track_local(
+                detail::invoke<Type, Calling>(clazz, object, method, args...),
+                *method)}
             .array()
             .value();
-    } else if constexpr(Type == return_type::void_)
-    {
-        if constexpr(Calling == calling_method::static_)
-            GetJNI()->CallStaticVoidMethodA(clazz, *method, values.data());
-        else
-            GetJNI()->CallVoidMethodA(object, *method, values.data());
-    }
+    } else
+        return detail::invoke<Type, Calling>(clazz, object, method, args...);
 }
 
+template<return_type Type, typename Result>
+inline auto translate_result(Result out, java::method_handle const& method);
+
 template<return_type Type, calling_method Calling, typename... Args>
 inline auto call(
-    java::clazz clazz, java::object obj, java::method method, Args... args);
+    ::jclass            clazz,
+    ::jobject           obj,
+    java::method_handle method,
+    Args... args);
+
+/*!
+ * \brief Same as call(), but returns a jnipp::expected holding either the
+ * result or the Java exception, instead of throwing
+ */
+template<return_type Type, calling_method Calling, typename... Args>
+inline auto try_call(
+    ::jclass            clazz,
+    ::jobject           obj,
+    java::method_handle method,
+    Args... args);
 
 } // namespace call
 
@@ -183,6 +269,12 @@ struct instance_call
                 std::forward<Args>(args)...);
     }
 
+    inline auto try_call(Args... args)
+    {
+        return call::try_call<RType, call::calling_method::instanced_>(
+            {}, method.instance, method.method, std::forward<Args>(args)...);
+    }
+
     java::method_reference method;
 };
 
@@ -204,6 +296,12 @@ struct static_call
                 method.clazz, {}, method.method, std::forward<Args>(args)...);
     }
 
+    inline auto try_call(Args... args)
+    {
+        return call::try_call<RType, call::calling_method::static_>(
+            method.clazz, {}, method.method, std::forward<Args>(args)...);
+    }
+
     java::static_method_reference method;
 };
 
@@ -215,12 +313,16 @@ struct constructor_call
     {
     }
 
+    /*!
+     * \brief Construct an object, throwing the constructor's exception
+     * \param args
+     * \return
+     */
     inline optional<java::object> operator()(Args... args)
     {
-        std::vector<jvalue> values = arguments::get_args(args...);
-
         auto instance =
-            GetJNI()->NewObject(method.clazz, *method.method, values.data());
+            accounting::track_local(construct(args...), *method.method);
+        call::check_exception();
 
         java::object out(method.clazz, instance);
 
@@ -231,6 +333,22 @@ struct constructor_call
     }
 
     java::static_method_reference method;
+
+  private:
+    ::jobject construct(Args... args) const
+    {
+        auto env = GetJNI();
+
+        if constexpr((arguments::is_direct<Args> && ...))
+            return env->NewObject(
+                method.clazz, *method.method, arguments::direct(args)...);
+        else
+        {
+            auto values = arguments::get_args(args...);
+            return env->NewObjectA(
+                method.clazz, *method.method, values.data());
+        }
+    }
 };
 
 } // namespace jnipp::invocation
@@ -245,15 +363,25 @@ struct jmethod
     {
     }
 
+    /* Each builder has an overload for temporaries, which moves the method
+     * along instead of copying it at every step */
+
     template<return_type T2>
     /*!
      * \brief define a POD or POD array return type
      * \return
      */
-    jmethod<T2, Args...> ret()
+    jmethod<T2, Args...> ret() const&
     {
-        method.ret(type_signature::to_str<T2>());
-        return {std::move(method)};
+        return jmethod(*this).template ret<T2>();
+    }
+
+    template<return_type T2>
+    jmethod<T2, Args...> ret() &&
+    {
+        auto out = std::move(method);
+        out.ret(type_signature::to_str<T2>());
+        return {std::move(out)};
     }
 
     /*!
@@ -261,11 +389,19 @@ struct jmethod
      * \param ret_type Java class name for return type
      * \return
      */
-    jmethod<return_type::object_, Args...> ret(std::string const& ret_type)
+    jmethod<return_type::object_, Args...> ret(
+        std::string const& ret_type) const&
     {
-        method.ret(type_signature::classify(ret_type));
-        method.return_class = ret_type;
-        return {std::move(method)};
+        return jmethod(*this).ret(ret_type);
+    }
+
+    jmethod<return_type::object_, Args...> ret(std::string const& ret_type) &&
+    {
+        auto out = std::move(method);
+        out.ret(type_signature::classify(ret_type));
+        out.return_class =
+            cache::descriptors().intern(type_signature::slashify(ret_type));
+        return {std::move(out)};
     }
 
     template<return_type T2>
@@ -275,11 +411,21 @@ struct jmethod
      * \param type Java class name of returned type
      * \return
      */
-    jmethod<return_type::object_array_, Args...> ret(std::string const& type)
+    jmethod<return_type::object_array_, Args...> ret(
+        std::string const& type) const&
     {
-        method.ret(type_signature::to_str<T2>(type));
-        method.return_class = type;
-        return {std::move(method)};
+        return jmethod(*this).template ret<T2>(type);
+    }
+
+    template<return_type T2>
+    requires(T2 == return_type::object_array_)
+    jmethod<return_type::object_array_, Args...> ret(std::string const& type) &&
+    {
+        auto out = std::move(method);
+        out.ret(type_signature::to_str<T2>(type));
+        out.return_class =
+            cache::descriptors().intern(type_signature::slashify(type));
+        return {std::move(out)};
     }
 
     template<typename T2>
@@ -287,10 +433,17 @@ struct jmethod
      * \brief define argument with POD or POD array type
      * \return
      */
-    jmethod<RType, Args..., T2> arg()
+    jmethod<RType, Args..., T2> arg() const&
+    {
+        return jmethod(*this).template arg<T2>();
+    }
+
+    template<typename T2>
+    jmethod<RType, Args..., T2> arg() &&
     {
-        method.arg(type_signature::to_str<T2>());
-        return {std::move(method)};
+        auto out = std::move(method);
+        out.arg(type_signature::to_str<T2>());
+        return {std::move(out)};
     }
 
     template<typename T2>
@@ -300,10 +453,17 @@ struct jmethod
      * \param type Java class name for argument, or JNI POD type
      * \return
      */
-    jmethod<RType, Args..., T2> arg(std::string const& type)
+    jmethod<RType, Args..., T2> arg(std::string const& type) const&
     {
-        method.arg(type_signature::classify(type));
-        return {std::move(method)};
+        return jmethod(*this).template arg<T2>(type);
+    }
+
+    template<typename T2>
+    jmethod<RType, Args..., T2> arg(std::string const& type) &&
+    {
+        auto out = std::move(method);
+        out.arg(type_signature::classify(type));
+        return {std::move(out)};
     }
 
     /*!
@@ -311,10 +471,16 @@ struct jmethod
      * \param type
      * \return
      */
-    jmethod<RType, Args..., ::jvalue> arg(std::string const& type)
+    jmethod<RType, Args..., ::jvalue> arg(std::string const& type) const&
+    {
+        return jmethod(*this).arg(type);
+    }
+
+    jmethod<RType, Args..., ::jvalue> arg(std::string const& type) &&
     {
-        method.arg(type_signature::classify(type));
-        return {std::move(method)};
+        auto out = std::move(method);
+        out.arg(type_signature::classify(type));
+        return {std::move(out)};
     }
 
     const char* name() const
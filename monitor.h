@@ -0,0 +1,57 @@
+#pragma once
+
+#include "class_wrapper.h"
+#include "jni_types.h"
+#include "method_calls.h"
+
+#include <stdexcept>
+
+namespace jnipp {
+
+/*!
+ * \brief Holds the monitor of a Java object, like a synchronized block. The
+ * monitor is released when the scope ends, including when it is left by a
+ * C++ exception, eg. one thrown by check_exception(). It must be released on
+ * the thread that entered it.
+ */
+struct monitor_scope
+{
+    /*!
+     * \param object
+     */
+    explicit monitor_scope(wrapping::jobject const& object)
+        : monitor_scope(object.object.instance)
+    {
+    }
+
+    /*!
+     * \param object any reference to the object, which must stay valid
+     * until the scope ends
+     * \param env
+     */
+    explicit monitor_scope(::jobject object, JNIEnv* env = GetJNI())
+        : m_object(object)
+        , m_env(env)
+    {
+        if(m_env->MonitorEnter(m_object) != JNI_OK)
+        {
+            invocation::call::check_exception();
+            throw std::runtime_error("failed to enter monitor");
+        }
+    }
+
+    monitor_scope(monitor_scope const&) = delete;
+    monitor_scope& operator=(monitor_scope const&) = delete;
+
+    ~monitor_scope()
+    {
+        /* Allowed with an exception pending */
+        m_env->MonitorExit(m_object);
+    }
+
+  private:
+    ::jobject m_object;
+    JNIEnv*   m_env;
+};
+
+} // namespace jnipp
@@ -0,0 +1,273 @@
+#pragma once
+
+#include "cache.h"
+#include "checks.h"
+#include "class_wrapper.h"
+#include "jni_types.h"
+#include "object_test.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+
+/* C++ objects attached to Java objects. The peer is reached through a long
+ * field declared by the Java class, which holds a pointer to a small box
+ * owning the peer, so that finding the peer of an object is a single
+ * GetLongField. When an object is attached, it is registered with a shared
+ * java.lang.ref.Cleaner, which deletes the peer once the object has become
+ * phantom reachable.
+ *
+ * The cleaner action is a Runnable with a native method, defined from
+ * embedded bytes like the gather helper. Cleaner needs Java 9, or API level
+ * 33 on Android, where DefineClass is not supported and the peer registry is
+ * unavailable. The library must stay loaded for as long as peers may be
+ * cleaned up.
+ */
+
+namespace jnipp {
+
+namespace detail {
+
+/* Class file of jnipp.PeerCleanup, version 49, equivalent to:
+ *
+ *  package jnipp;
+ *
+ *  public final class PeerCleanup implements Runnable {
+ *      private final long box;
+ *
+ *      public PeerCleanup(long box) {
+ *          this.box = box;
+ *      }
+ *
+ *      public void run() {
+ *          release(box);
+ *      }
+ *
+ *      private static native void release(long box);
+ *  }
+ */
+inline constexpr unsigned char peer_cleanup_class[] = {
+    0xca, 0xfe, 0xba, 0xbe, 0x00, 0x00, 0x00, 0x31, 0x00, 0x15, 0x01, 0x00,
+    0x11, 0x6a, 0x6e, 0x69, 0x70, 0x70, 0x2f, 0x50, 0x65, 0x65, 0x72, 0x43,
+    0x6c, 0x65, 0x61, 0x6e, 0x75, 0x70, 0x07, 0x00, 0x01, 0x01, 0x00, 0x10,
+    0x6a, 0x61, 0x76, 0x61, 0x2f, 0x6c, 0x61, 0x6e, 0x67, 0x2f, 0x4f, 0x62,
+    0x6a, 0x65, 0x63, 0x74, 0x07, 0x00, 0x03, 0x01, 0x00, 0x12, 0x6a, 0x61,
+    0x76, 0x61, 0x2f, 0x6c, 0x61, 0x6e, 0x67, 0x2f, 0x52, 0x75, 0x6e, 0x6e,
+    0x61, 0x62, 0x6c, 0x65, 0x07, 0x00, 0x05, 0x01, 0x00, 0x04, 0x43, 0x6f,
+    0x64, 0x65, 0x01, 0x00, 0x06, 0x3c, 0x69, 0x6e, 0x69, 0x74, 0x3e, 0x01,
+    0x00, 0x03, 0x28, 0x29, 0x56, 0x0c, 0x00, 0x08, 0x00, 0x09, 0x0a, 0x00,
+    0x04, 0x00, 0x0a, 0x01, 0x00, 0x03, 0x62, 0x6f, 0x78, 0x01, 0x00, 0x01,
+    0x4a, 0x0c, 0x00, 0x0c, 0x00, 0x0d, 0x09, 0x00, 0x02, 0x00, 0x0e, 0x01,
+    0x00, 0x07, 0x72, 0x65, 0x6c, 0x65, 0x61, 0x73, 0x65, 0x01, 0x00, 0x04,
+    0x28, 0x4a, 0x29, 0x56, 0x0c, 0x00, 0x10, 0x00, 0x11, 0x0a, 0x00, 0x02,
+    0x00, 0x12, 0x01, 0x00, 0x03, 0x72, 0x75, 0x6e, 0x00, 0x31, 0x00, 0x02,
+    0x00, 0x04, 0x00, 0x01, 0x00, 0x06, 0x00, 0x01, 0x00, 0x12, 0x00, 0x0c,
+    0x00, 0x0d, 0x00, 0x00, 0x00, 0x03, 0x00, 0x01, 0x00, 0x08, 0x00, 0x11,
+    0x00, 0x01, 0x00, 0x07, 0x00, 0x00, 0x00, 0x16, 0x00, 0x03, 0x00, 0x03,
+    0x00, 0x00, 0x00, 0x0a, 0x2a, 0xb7, 0x00, 0x0b, 0x2a, 0x1f, 0xb5, 0x00,
+    0x0f, 0xb1, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x14, 0x00, 0x09,
+    0x00, 0x01, 0x00, 0x07, 0x00, 0x00, 0x00, 0x14, 0x00, 0x02, 0x00, 0x01,
+    0x00, 0x00, 0x00, 0x08, 0x2a, 0xb4, 0x00, 0x0f, 0xb8, 0x00, 0x13, 0xb1,
+    0x00, 0x00, 0x00, 0x00, 0x01, 0x0a, 0x00, 0x10, 0x00, 0x11, 0x00, 0x00,
+    0x00, 0x00,
+};
+
+/*!
+ * \brief Owner of an attached peer, which outlives the peer itself if it is
+ * detached, until the Java object is cleaned up
+ */
+struct peer_box
+{
+    void* peer;
+    void (*destroy)(void*);
+};
+
+inline void JNICALL peer_release(JNIEnv*, ::jclass, jlong handle)
+{
+    auto box = reinterpret_cast<peer_box*>(handle);
+
+    if(box->peer)
+        box->destroy(box->peer);
+
+    delete box;
+}
+
+/*!
+ * \brief The cleanup class, the Cleaner and their methods, set up once
+ */
+struct peer_metadata
+{
+    static peer_metadata const& get()
+    {
+        static const peer_metadata metadata;
+        return metadata;
+    }
+
+    ::jclass    clazz;
+    ::jmethodID constructor;
+    ::jmethodID register_;
+
+    /* Never released, like the cached classes. This lives in a static, and
+     * a static destructor may run after the VM is gone or on a thread that
+     * is not attached. */
+    ::jobject cleaner;
+
+  private:
+    peer_metadata()
+    {
+        auto env = GetJNI();
+
+        clazz = cache::classes().define(
+            "jnipp/PeerCleanup",
+            peer_cleanup_class,
+            sizeof(peer_cleanup_class),
+            env);
+        invocation::call::check_exception();
+
+        JNINativeMethod natives[] = {{
+            const_cast<char*>("release"),
+            const_cast<char*>("(J)V"),
+            reinterpret_cast<void*>(&peer_release),
+        }};
+        env->RegisterNatives(clazz, natives, 1);
+        invocation::call::check_exception();
+
+        constructor = cache::method_id(clazz, "<init>", "(J)V", false, env);
+
+        auto Cleaner = cache::classes().resolve("java/lang/ref/Cleaner", env);
+        invocation::call::check_exception();
+
+        register_ = cache::method_id(
+            Cleaner,
+            "register",
+            "(Ljava/lang/Object;Ljava/lang/Runnable;)"
+            "Ljava/lang/ref/Cleaner$Cleanable;",
+            false,
+            env);
+        auto create = cache::method_id(
+            Cleaner, "create", "()Ljava/lang/ref/Cleaner;", true, env);
+        invocation::call::check_exception();
+
+        auto local = env->CallStaticObjectMethod(Cleaner, create);
+        invocation::call::check_exception();
+
+        cleaner = env->NewGlobalRef(local);
+        env->DeleteLocalRef(local);
+    }
+};
+
+} // namespace detail
+
+template<typename T>
+/*!
+ * \brief Registry of C++ peers of type T, stored in a long field of a Java
+ * class. The field must not be written by Java code. Attaching and detaching
+ * are not synchronized, an object should only have its peer changed by one
+ * thread at a time.
+ */
+struct native_peer
+{
+    /*!
+     * \param clazz class declaring the field
+     * \param field name of a non-static long field, initially 0
+     */
+    native_peer(wrapping::jclass const& clazz, std::string const& field)
+        : clazz(clazz.clazz)
+    {
+        id = cache::field_id(this->clazz, field.c_str(), "J", false);
+        invocation::call::check_exception();
+    }
+
+    /*!
+     * \brief Look up the peer of an object
+     * \param object
+     * \return the peer, or nullptr if none is attached
+     */
+    T* get(wrapping::jobject const& object) const
+    {
+        auto existing = box(object);
+        return existing ? static_cast<T*>(existing->peer) : nullptr;
+    }
+
+    /*!
+     * \brief Attach a peer to an object, replacing and deleting the one
+     * already attached
+     * \param object
+     * \param peer
+     * \return the attached peer
+     */
+    T& attach(wrapping::jobject const& object, std::unique_ptr<T> peer) const
+    {
+        if constexpr(checks::types)
+            java::objects::verify_instance_of(object.object.instance, clazz);
+
+        auto& out = *peer;
+
+        if(auto existing = box(object))
+        {
+            if(existing->peer)
+                existing->destroy(existing->peer);
+            existing->peer    = peer.release();
+            existing->destroy = &destroy;
+            return out;
+        }
+
+        auto const& meta = detail::peer_metadata::get();
+        auto        env  = GetJNI();
+
+        auto box = std::make_unique<detail::peer_box>(
+            detail::peer_box{peer.get(), &destroy});
+        auto handle = reinterpret_cast<jlong>(box.get());
+
+        auto action = env->NewObject(meta.clazz, meta.constructor, handle);
+        invocation::call::check_exception();
+
+        auto cleanable = env->CallObjectMethod(
+            meta.cleaner, meta.register_, object.object.instance, action);
+        env->DeleteLocalRef(action);
+        invocation::call::check_exception();
+        env->DeleteLocalRef(cleanable);
+
+        /* The cleaner owns the box from here on */
+        env->SetLongField(object.object.instance, id, handle);
+        box.release();
+
+        peer.release();
+
+        return out;
+    }
+
+    /*!
+     * \brief Take the peer back from an object, which leaves the object
+     * without a peer
+     * \param object
+     * \return the peer, or nullptr if none was attached
+     */
+    std::unique_ptr<T> detach(wrapping::jobject const& object) const
+    {
+        auto existing = box(object);
+
+        if(!existing)
+            return {};
+
+        return std::unique_ptr<T>(
+            static_cast<T*>(std::exchange(existing->peer, nullptr)));
+    }
+
+  private:
+    static void destroy(void* peer)
+    {
+        delete static_cast<T*>(peer);
+    }
+
+    detail::peer_box* box(wrapping::jobject const& object) const
+    {
+        return reinterpret_cast<detail::peer_box*>(
+            GetJNI()->GetLongField(object.object.instance, id));
+    }
+
+    ::jclass   clazz;
+    ::jfieldID id;
+};
+
+} // namespace jnipp
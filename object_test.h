@@ -1,5 +1,6 @@
 #pragma once
 
+#include "cache.h"
 #include "errors.h"
 #include "jni_types.h"
 
@@ -10,7 +11,7 @@ inline void verify_instance_of(jobject instance, std::string const& className)
     if(!instance)
         throw java_exception("null object");
 
-    auto classId = GetJNI()->FindClass(className.c_str());
+    auto classId = cache::classes().resolve(className);
 
     if(GetJNI()->IsInstanceOf(instance, classId) == JNI_FALSE)
     {
@@ -18,6 +19,17 @@ inline void verify_instance_of(jobject instance, std::string const& className)
     }
 }
 
+inline void verify_instance_of(jobject instance, jclass clazz)
+{
+    if(!instance)
+        throw java_exception("null object");
+
+    if(GetJNI()->IsInstanceOf(instance, clazz) == JNI_FALSE)
+    {
+        throw java_type_cast_exception("invalid cast");
+    }
+}
+
 inline bool not_null(optional<java::object> instance)
 {
     return instance.has_value() && instance->instance;
@@ -0,0 +1,458 @@
+#pragma once
+
+#include "jni_types.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+/* Reference accounting, enabled by defining JNIPP_REF_ACCOUNTING=1.
+ *
+ * Every local and global reference handed out by the wrappers is counted
+ * against the call site that produced it, ie. the class and method or field,
+ * along with when it is released again, either explicitly or by popping its
+ * local frame. Counts are kept per thread, and for any accounting::scope
+ * that is alive, so a code path can be checked against a reference budget.
+ *
+ * Global references are also counted against the thread that releases
+ * them, but a scope only counts the release of a reference it saw being
+ * created. References created directly through JNIEnv are not seen.
+ */
+#ifndef JNIPP_REF_ACCOUNTING
+#define JNIPP_REF_ACCOUNTING 0
+#endif
+
+namespace jnipp::accounting {
+
+constexpr bool enabled = JNIPP_REF_ACCOUNTING != 0;
+
+struct site_stats
+{
+    std::string site;
+    int64_t     created    = 0;
+    int64_t     released   = 0;
+    int64_t     live       = 0;
+    int64_t     high_water = 0;
+};
+
+struct report
+{
+    std::vector<site_stats> locals;
+    std::vector<site_stats> globals;
+
+    int64_t local_high_water  = 0;
+    int64_t global_high_water = 0;
+
+    /*!
+     * \brief Sum of references that were created and not released
+     * \return
+     */
+    int64_t outstanding() const
+    {
+        int64_t out = 0;
+        for(auto const& site : locals)
+            out += site.live;
+        for(auto const& site : globals)
+            out += site.live;
+        return out;
+    }
+};
+
+using report_handler = std::function<void(report const&)>;
+
+namespace detail {
+
+struct tracker
+{
+    void created(bool global, std::string_view site)
+    {
+        auto& stats = entry(global, site);
+        stats.created++;
+        stats.high_water = std::max(stats.high_water, ++stats.live);
+
+        auto& live = global ? global_live : local_live;
+        auto& high = global ? global_high : local_high;
+        high       = std::max(high, ++live);
+    }
+
+    void released(bool global, std::string_view site)
+    {
+        auto& stats = entry(global, site);
+        stats.released++;
+        stats.live--;
+
+        (global ? global_live : local_live)--;
+    }
+
+    accounting::report report() const
+    {
+        accounting::report out;
+        out.local_high_water  = local_high;
+        out.global_high_water = global_high;
+
+        for(auto const& [_, stats] : locals)
+            out.locals.push_back(stats);
+        for(auto const& [_, stats] : globals)
+            out.globals.push_back(stats);
+
+        return out;
+    }
+
+    std::map<std::string, site_stats, std::less<>> locals;
+    std::map<std::string, site_stats, std::less<>> globals;
+
+    /* Clock of the thread when the tracker was opened, references created
+     * earlier are not counted when released */
+    uint64_t opened = 0;
+
+    int64_t local_live  = 0;
+    int64_t local_high  = 0;
+    int64_t global_live = 0;
+    int64_t global_high = 0;
+
+  private:
+    site_stats& entry(bool global, std::string_view site)
+    {
+        auto& sites = global ? globals : locals;
+        auto  it    = sites.find(site);
+
+        if(it == sites.end())
+            it = sites.emplace(std::string(site), site_stats{std::string(site)})
+                     .first;
+
+        return it->second;
+    }
+};
+
+/*!
+ * \brief Where and when a reference was created, the time being the clock of
+ * the creating thread
+ */
+struct origin
+{
+    std::string     site;
+    std::thread::id thread;
+    uint64_t        time;
+};
+
+struct process_state
+{
+    std::mutex lock;
+
+    std::unordered_map<const void*, std::string> sites;
+    std::unordered_map<::jobject, origin>        globals;
+
+    report_handler on_thread_exit;
+};
+
+inline process_state& process()
+{
+    static process_state state;
+    return state;
+}
+
+struct thread_state
+{
+    thread_state()
+        : frames(1)
+    {
+    }
+
+    ~thread_state()
+    {
+        report_handler handler;
+
+        {
+            std::lock_guard _(process().lock);
+            handler = process().on_thread_exit;
+        }
+
+        auto out = total.report();
+
+        if(handler && out.outstanding() != 0)
+            handler(out);
+    }
+
+    template<typename Function>
+    void each(Function&& function)
+    {
+        function(total);
+        for(auto scope : scopes)
+            function(*scope);
+    }
+
+    /*!
+     * \brief Same as each(), but skips the scopes that were opened after the
+     * reference was created, which never counted it
+     */
+    template<typename Function>
+    void each_seen(origin const& ref, Function&& function)
+    {
+        function(total);
+
+        if(ref.thread != std::this_thread::get_id())
+            return;
+
+        for(auto scope : scopes)
+            if(scope->opened <= ref.time)
+                function(*scope);
+    }
+
+    origin now(std::string_view site) const
+    {
+        return {std::string(site), std::this_thread::get_id(), clock};
+    }
+
+    tracker               total;
+    std::vector<tracker*> scopes;
+
+    /* Advanced whenever a scope is opened */
+    uint64_t clock = 0;
+
+    /* Live local references by frame, the first one being the thread's own
+     * frame */
+    std::vector<std::unordered_map<::jobject, origin>> frames;
+};
+
+inline thread_state& thread()
+{
+    thread_local thread_state state;
+    return state;
+}
+
+} // namespace detail
+
+/*!
+ * \brief Give a method or field ID a readable name for reports
+ * \param id jmethodID or jfieldID
+ * \param name eg. java/io/File.getPath
+ */
+inline void name_site(const void* id, std::string name)
+{
+    std::lock_guard _(detail::process().lock);
+    detail::process().sites.emplace(id, std::move(name));
+}
+
+/*!
+ * \brief Name of a method or field ID, as given to name_site()
+ * \param id
+ * \return
+ */
+inline std::string site_of(const void* id)
+{
+    std::lock_guard _(detail::process().lock);
+
+    auto it = detail::process().sites.find(id);
+    return it != detail::process().sites.end() ? it->second : "<unknown>";
+}
+
+inline void local_created(::jobject ref, std::string_view site)
+{
+    if(!ref)
+        return;
+
+    auto& state = detail::thread();
+    state.frames.back().insert_or_assign(ref, state.now(site));
+    state.each([&](detail::tracker& t) { t.created(false, site); });
+}
+
+template<typename T>
+/*!
+ * \brief Count a local reference returned by a method or field, does nothing
+ * unless accounting is enabled
+ * \param ref
+ * \param id jmethodID or jfieldID that produced it
+ * \return ref
+ */
+inline T track_local(T ref, const void* id)
+{
+    if constexpr(enabled)
+        local_created(ref, site_of(id));
+    return ref;
+}
+
+inline void local_released(::jobject ref)
+{
+    auto& state = detail::thread();
+
+    for(auto frame = state.frames.rbegin(); frame != state.frames.rend();
+        ++frame)
+    {
+        auto it = frame->find(ref);
+
+        if(it == frame->end())
+            continue;
+
+        state.each_seen(it->second, [&](detail::tracker& t) {
+            t.released(false, it->second.site);
+        });
+        frame->erase(it);
+        return;
+    }
+}
+
+/*!
+ * \brief Site of a live local reference, eg. to count the copy returned by
+ * PopLocalFrame() against the same site
+ * \param ref
+ * \return
+ */
+inline std::string local_site(::jobject ref)
+{
+    auto& state = detail::thread();
+
+    for(auto frame = state.frames.rbegin(); frame != state.frames.rend();
+        ++frame)
+        if(auto it = frame->find(ref); it != frame->end())
+            return it->second.site;
+
+    return "<unattributed>";
+}
+
+/*!
+ * \brief Count a global reference, attributed to the site of the reference
+ * it was created from
+ * \param ref
+ * \param from
+ */
+inline void global_created(::jobject ref, ::jobject from)
+{
+    if(!ref)
+        return;
+
+    auto& state = detail::thread();
+    auto  site  = local_site(from);
+
+    {
+        std::lock_guard _(detail::process().lock);
+
+        auto& globals = detail::process().globals;
+
+        /* Copy of another global reference */
+        if(auto it = globals.find(from); it != globals.end())
+            site = it->second.site;
+
+        globals.insert_or_assign(ref, state.now(site));
+    }
+
+    state.each([&](detail::tracker& t) { t.created(true, site); });
+}
+
+inline void global_released(::jobject ref)
+{
+    detail::origin from;
+
+    {
+        std::lock_guard _(detail::process().lock);
+
+        auto it = detail::process().globals.find(ref);
+        if(it == detail::process().globals.end())
+            return;
+
+        from = std::move(it->second);
+        detail::process().globals.erase(it);
+    }
+
+    detail::thread().each_seen(from, [&](detail::tracker& t) {
+        t.released(true, from.site);
+    });
+}
+
+inline void frame_pushed()
+{
+    detail::thread().frames.emplace_back();
+}
+
+/*!
+ * \brief Release all local references of the innermost frame
+ */
+inline void frame_popped()
+{
+    auto& state = detail::thread();
+
+    if(state.frames.size() <= 1)
+        return;
+
+    for(auto const& [_, from] : state.frames.back())
+        state.each_seen(from, [&](detail::tracker& t) {
+            t.released(false, from.site);
+        });
+
+    state.frames.pop_back();
+}
+
+/*!
+ * \brief Called with the totals of a thread when it exits with references
+ * outstanding
+ * \param handler
+ */
+inline void set_thread_exit_handler(report_handler handler)
+{
+    std::lock_guard _(detail::process().lock);
+    detail::process().on_thread_exit = std::move(handler);
+}
+
+/*!
+ * \brief Totals for the current thread
+ * \return
+ */
+inline report thread_report()
+{
+    return detail::thread().total.report();
+}
+
+/*!
+ * \brief Counts the references created on this thread while it is alive,
+ * and their releases. Releasing a reference that was created before the
+ * scope opened does not count. Scopes may be nested, and each sees
+ * everything below it.
+ */
+struct scope
+{
+    /*!
+     * \param on_exit called from the destructor if references created in the
+     * scope are still outstanding
+     */
+    explicit scope(report_handler on_exit = {})
+        : m_on_exit(std::move(on_exit))
+    {
+        auto& state      = detail::thread();
+        m_tracker.opened = ++state.clock;
+        state.scopes.push_back(&m_tracker);
+    }
+
+    scope(scope const&) = delete;
+    scope& operator=(scope const&) = delete;
+
+    ~scope()
+    {
+        auto& scopes = detail::thread().scopes;
+        scopes.erase(std::find(scopes.begin(), scopes.end(), &m_tracker));
+
+        if(!m_on_exit)
+            return;
+
+        auto out = m_tracker.report();
+
+        if(out.outstanding() != 0)
+            m_on_exit(out);
+    }
+
+    accounting::report report() const
+    {
+        return m_tracker.report();
+    }
+
+  private:
+    detail::tracker m_tracker;
+    report_handler  m_on_exit;
+};
+
+} // namespace jnipp::accounting
@@ -0,0 +1,166 @@
+#pragma once
+
+#include "jni_types.h"
+#include "ref_accounting.h"
+
+#include <utility>
+
+namespace jnipp {
+
+template<typename T = ::jobject>
+/*!
+ * \brief Owning global reference, which keeps a Java object alive until it
+ * goes out of scope. The reference is released with GetJNI(), so it must be
+ * destroyed on a thread attached to the JVM.
+ */
+struct global_ref
+{
+    global_ref()
+    {
+    }
+
+    /*!
+     * \brief Create a new global reference to an object
+     * \param object any reference to the object, which is not released
+     * \param env
+     */
+    explicit global_ref(T object, JNIEnv* env = GetJNI())
+        : m_ref(object ? reinterpret_cast<T>(env->NewGlobalRef(object))
+                       : nullptr)
+    {
+        if constexpr(accounting::enabled)
+            accounting::global_created(m_ref, object);
+    }
+
+    global_ref(global_ref const& other)
+        : global_ref(other.m_ref)
+    {
+    }
+
+    global_ref(global_ref&& other)
+        : m_ref(std::exchange(other.m_ref, nullptr))
+    {
+    }
+
+    ~global_ref()
+    {
+        reset();
+    }
+
+    global_ref& operator=(global_ref const& other)
+    {
+        if(this != &other)
+            *this = global_ref(other);
+        return *this;
+    }
+
+    global_ref& operator=(global_ref&& other)
+    {
+        if(this != &other)
+        {
+            reset();
+            m_ref = std::exchange(other.m_ref, nullptr);
+        }
+        return *this;
+    }
+
+    void reset()
+    {
+        if(m_ref)
+        {
+            if constexpr(accounting::enabled)
+                accounting::global_released(m_ref);
+            GetJNI()->DeleteGlobalRef(m_ref);
+        }
+        m_ref = nullptr;
+    }
+
+    /*!
+     * \brief Give up ownership of the reference without releasing it
+     * \return
+     */
+    T release()
+    {
+        return std::exchange(m_ref, nullptr);
+    }
+
+    T get() const
+    {
+        return m_ref;
+    }
+
+    operator T() const
+    {
+        return m_ref;
+    }
+
+    explicit operator bool() const
+    {
+        return m_ref;
+    }
+
+  private:
+    T m_ref = nullptr;
+};
+
+/*!
+ * \brief Scope for local references, all local references created while it
+ * is alive are released when it goes out of scope
+ */
+struct local_frame
+{
+    /*!
+     * \param capacity number of local references to reserve
+     * \param env
+     */
+    explicit local_frame(jint capacity, JNIEnv* env = GetJNI())
+        : m_env(env)
+        , m_popped(env->PushLocalFrame(capacity) != JNI_OK)
+    {
+        if constexpr(accounting::enabled)
+            if(!m_popped)
+                accounting::frame_pushed();
+    }
+
+    local_frame(local_frame const&) = delete;
+    local_frame& operator=(local_frame const&) = delete;
+
+    ~local_frame()
+    {
+        if(!m_popped)
+            pop(nullptr);
+    }
+
+    /*!
+     * \brief Whether the frame was pushed and is not popped yet, if pushing
+     * failed the Java exception is left pending
+     */
+    explicit operator bool() const
+    {
+        return !m_popped;
+    }
+
+    /*!
+     * \brief Release the frame early, keeping one of its references alive
+     * \param result reference to keep, or nullptr
+     * \return a new local reference to result in the enclosing frame, which
+     * is not counted by the reference accounting
+     */
+    ::jobject pop(::jobject result)
+    {
+        m_popped = true;
+
+        auto out = m_env->PopLocalFrame(result);
+
+        if constexpr(accounting::enabled)
+            accounting::frame_popped();
+
+        return out;
+    }
+
+  private:
+    JNIEnv* m_env;
+    bool    m_popped;
+};
+
+} // namespace jnipp
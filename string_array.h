@@ -0,0 +1,171 @@
+#pragma once
+
+#include "cache.h"
+#include "checks.h"
+#include "errors.h"
+#include "jni_types.h"
+#include "references.h"
+#include "unwrappers.h"
+#include "utf.h"
+
+#include <algorithm>
+#include <memory_resource>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace jnipp::java {
+
+/*!
+ * \brief The contents of a String[], with all characters stored back to back
+ * in a single arena. Null elements are read as empty strings. The arena and
+ * offsets are allocated from a memory resource.
+ */
+struct string_table
+{
+    string_table(
+        std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+        : arena(resource)
+        , offsets(resource)
+    {
+    }
+
+    size_t size() const
+    {
+        return offsets.empty() ? 0 : offsets.size() - 1;
+    }
+
+    /*!
+     * \brief View of a string, valid for as long as the table is alive and
+     * unmodified
+     * \param index
+     * \return
+     */
+    std::string_view operator[](size_t index) const
+    {
+        return std::string_view(arena).substr(
+            offsets[index], offsets[index + 1] - offsets[index]);
+    }
+
+    std::vector<std::string_view> views() const
+    {
+        std::vector<std::string_view> out;
+        out.reserve(size());
+        for(size_t i = 0; i < size(); i++)
+            out.push_back((*this)[i]);
+        return out;
+    }
+
+    std::vector<std::string> strings() const
+    {
+        std::vector<std::string> out;
+        out.reserve(size());
+        for(size_t i = 0; i < size(); i++)
+            out.emplace_back((*this)[i]);
+        return out;
+    }
+
+    std::pmr::string         arena;
+    std::pmr::vector<size_t> offsets;
+};
+
+/*!
+ * \brief Read a whole String[] at once. Elements are fetched in chunks, each
+ * inside its own local frame, so the local references are released as it
+ * goes. The arena grows once per chunk, by the worst case for the chunk's
+ * total UTF-16 length, and the strings are converted straight into it. The
+ * element type is checked once for the whole array.
+ * \param array
+ * \param resource where the table allocates from
+ * \param chunk number of elements per local frame, must be positive
+ * \return
+ */
+inline string_table read_strings(
+    java::array const&         array,
+    std::pmr::memory_resource* resource,
+    jsize                      chunk = 256)
+{
+    if(chunk <= 0)
+        throw std::invalid_argument("chunk must be positive");
+
+    auto env      = GetJNI();
+    auto elements = reinterpret_cast<jobjectArray>(array.instance);
+
+    if constexpr(checks::types)
+        objects::verify_instance_of(array.instance, "[Ljava/lang/String;");
+
+    auto length = env->GetArrayLength(elements);
+
+    string_table out(resource);
+    out.offsets.reserve(static_cast<size_t>(length) + 1);
+    out.offsets.push_back(0);
+
+    struct element
+    {
+        jstring str;
+        size_t  length;
+    };
+
+    std::vector<element> batch;
+    batch.reserve(static_cast<size_t>(std::min(length, chunk)));
+
+    for(jsize start = 0; start < length; start += chunk)
+    {
+        auto end = start + std::min(chunk, length - start);
+
+        local_frame _(end - start, env);
+
+        batch.clear();
+        size_t units = 0;
+
+        for(jsize i = start; i < end; i++)
+        {
+            auto str = reinterpret_cast<jstring>(
+                env->GetObjectArrayElement(elements, i));
+            auto size =
+                str ? static_cast<size_t>(env->GetStringLength(str)) : 0;
+
+            batch.push_back({str, size});
+            units += size;
+        }
+
+        auto offset = out.arena.size();
+        out.arena.resize(offset + utf::max_utf8_length(units));
+
+        /* Null elements are read as empty strings */
+        for(auto const& [str, size] : batch)
+        {
+            if(str)
+                offset +=
+                    utf::from_java(str, size, out.arena.data() + offset, env);
+
+            out.offsets.push_back(offset);
+        }
+
+        out.arena.resize(offset);
+    }
+
+    return out;
+}
+
+inline string_table read_strings(java::array const& array, jsize chunk = 256)
+{
+    return read_strings(array, std::pmr::get_default_resource(), chunk);
+}
+
+inline string_table read_strings(
+    array_type_unwrapper<return_type::object_> const& array, jsize chunk = 256)
+{
+    return read_strings(array.arrayRef, chunk);
+}
+
+inline string_table read_strings(
+    array_type_unwrapper<return_type::object_> const& array,
+    std::pmr::memory_resource*                        resource,
+    jsize                                             chunk = 256)
+{
+    return read_strings(array.arrayRef, resource, chunk);
+}
+
+} // namespace jnipp::java
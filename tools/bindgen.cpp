@@ -0,0 +1,530 @@
+#include <jnipp.h>
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <set>
+#include <sstream>
+
+/* Generates typed proxies for Java classes, by reflecting over them in a JVM
+ * started by the tool itself.
+ *
+ *  jnipp-bindgen [-cp classpath] [-o directory] [-n namespace] class...
+ *
+ * For each class, eg. java.io.File, a header <directory>/java/io/File.h is
+ * written, declaring bindings::java::io::File. Every public method and
+ * constructor becomes a member function, with its signature written out and
+ * its ID resolved the first time it is called.
+ */
+
+static JNIEnv* globalEnv;
+
+namespace jnipp {
+
+JNIEnv* GetJNI()
+{
+    return globalEnv;
+}
+
+} // namespace jnipp
+
+namespace {
+
+using namespace jnipp::literals;
+using jnipp::return_type;
+
+constexpr jint modifier_static = 0x0008;
+
+/*!
+ * \brief How a Java type is represented in the generated code
+ */
+struct type_mapping
+{
+    std::string descriptor;
+    std::string return_type;
+    std::string cpp_argument;
+    std::string cpp_result;
+    std::string result_class;
+};
+
+struct reflected_method
+{
+    std::string               name;
+    bool                      is_static;
+    bool                      is_constructor;
+    type_mapping              result;
+    std::vector<type_mapping> parameters;
+
+    std::string signature() const
+    {
+        std::string out = "(";
+        for(auto const& parameter : parameters)
+            out += parameter.descriptor;
+        return out + ")" + result.descriptor;
+    }
+};
+
+std::string unwrap(jnipp::wrapping::jobject const& str)
+{
+    return jnipp::java::type_unwrapper<std::string>(str.object);
+}
+
+/*!
+ * \brief Descriptor of a java.lang.Class, from Class.getName()
+ */
+std::string descriptor_of(std::string const& name)
+{
+    static const std::map<std::string, std::string> primitives = {
+        {"boolean", "Z"},
+        {"byte", "B"},
+        {"char", "C"},
+        {"short", "S"},
+        {"int", "I"},
+        {"long", "J"},
+        {"float", "F"},
+        {"double", "D"},
+        {"void", "V"},
+    };
+
+    if(auto it = primitives.find(name); it != primitives.end())
+        return it->second;
+
+    auto slashed = jnipp::type_signature::slashify(name);
+
+    if(name.front() == '[')
+        return slashed;
+
+    return "L" + slashed + ";";
+}
+
+type_mapping map_type(std::string const& descriptor)
+{
+    struct primitive
+    {
+        const char* cpp;
+        const char* type;
+    };
+
+    static const std::map<char, primitive> primitives = {
+        {'Z', {"jboolean", "bool_"}},
+        {'B', {"jbyte", "byte_"}},
+        {'C', {"jchar", "char_"}},
+        {'S', {"jshort", "short_"}},
+        {'I', {"jint", "int_"}},
+        {'J', {"jlong", "long_"}},
+        {'F', {"jfloat", "float_"}},
+        {'D', {"jdouble", "double_"}},
+    };
+
+    type_mapping out;
+    out.descriptor = descriptor;
+
+    if(descriptor == "V")
+    {
+        out.return_type = "void_";
+        out.cpp_result  = "void";
+    } else if(descriptor.size() == 1)
+    {
+        auto const& type = primitives.at(descriptor.front());
+        out.return_type  = type.type;
+        out.cpp_argument = type.cpp;
+        out.cpp_result   = type.cpp;
+    } else if(descriptor.size() == 2 && descriptor.front() == '[')
+    {
+        /* eg. int_ becomes int_array_ */
+        std::string element = primitives.at(descriptor[1]).type;
+
+        out.return_type  = element + "array_";
+        out.cpp_argument = "jnipp::java::object";
+        out.cpp_result   = "jnipp::java::array_type_unwrapper<"
+                         "jnipp::return_type::" +
+                         element + ">";
+    } else if(descriptor.front() == '[')
+    {
+        auto element = descriptor.substr(1);
+
+        out.return_type  = "object_array_";
+        out.cpp_argument = "jnipp::java::object";
+        out.cpp_result   = "jnipp::java::array_type_unwrapper<"
+                         "jnipp::return_type::object_>";
+        out.result_class = element.front() == 'L'
+                               ? element.substr(1, element.size() - 2)
+                               : element;
+    } else
+    {
+        out.return_type  = "object_";
+        out.cpp_argument = descriptor == "Ljava/lang/String;"
+                               ? "std::string"
+                               : "jnipp::java::object";
+        out.cpp_result   = "jnipp::wrapping::jobject";
+        out.result_class = descriptor.substr(1, descriptor.size() - 2);
+    }
+
+    return out;
+}
+
+/*!
+ * \brief Make a Java name usable as a C++ identifier
+ */
+std::string identifier(std::string name, std::set<std::string> const& taken)
+{
+    /* C++20 keywords and alternative tokens */
+    static const std::set<std::string> keywords = {
+        "alignas",           "alignof",           "and",
+        "and_eq",            "asm",               "auto",
+        "bitand",            "bitor",             "bool",
+        "break",             "case",              "catch",
+        "char",              "char16_t",          "char32_t",
+        "char8_t",           "class",             "co_await",
+        "co_return",         "co_yield",          "compl",
+        "concept",           "const",             "const_cast",
+        "consteval",         "constexpr",         "constinit",
+        "continue",          "decltype",          "default",
+        "delete",            "do",                "double",
+        "dynamic_cast",      "else",              "enum",
+        "explicit",          "export",            "extern",
+        "false",             "float",             "for",
+        "friend",            "goto",              "if",
+        "inline",            "int",               "long",
+        "mutable",           "namespace",         "new",
+        "noexcept",          "not",               "not_eq",
+        "nullptr",           "operator",          "or",
+        "or_eq",             "private",           "protected",
+        "public",            "register",          "reinterpret_cast",
+        "requires",          "return",            "short",
+        "signed",            "sizeof",            "static",
+        "static_assert",     "static_cast",       "struct",
+        "switch",            "template",          "this",
+        "thread_local",      "throw",             "true",
+        "try",               "typedef",           "typeid",
+        "typename",          "union",             "unsigned",
+        "using",             "virtual",           "void",
+        "volatile",          "wchar_t",           "while",
+        "xor",               "xor_eq",
+    };
+
+    for(auto& c : name)
+        if(c == '$')
+            c = '_';
+
+    if(keywords.count(name) || taken.count(name))
+        name += "_";
+
+    return name;
+}
+
+template<typename Function>
+void for_each(
+    jnipp::java::array_type_unwrapper<return_type::object_> const& array,
+    Function&&                                                     function)
+{
+    jnipp::java::array_extractors::extract_type<return_type::object_> elements(
+        array.arrayRef);
+
+    for(jsize i = 0; i < elements.length(); i++)
+        function(elements[i]);
+}
+
+std::vector<reflected_method> reflect(jnipp::wrapping::jobject const& clazz)
+{
+    static auto getName = "getName"_jmethod.ret("java.lang.String");
+    static auto getMethods =
+        "getMethods"_jmethod.ret<return_type::object_array_>(
+            "java.lang.reflect.Method");
+    static auto getConstructors =
+        "getConstructors"_jmethod.ret<return_type::object_array_>(
+            "java.lang.reflect.Constructor");
+    static auto getModifiers =
+        "getModifiers"_jmethod.ret<return_type::int_>();
+    static auto isBridge = "isBridge"_jmethod.ret<return_type::bool_>();
+    static auto isSynthetic = "isSynthetic"_jmethod.ret<return_type::bool_>();
+    static auto getReturnType = "getReturnType"_jmethod.ret("java.lang.Class");
+    static auto getParameterTypes =
+        "getParameterTypes"_jmethod.ret<return_type::object_array_>(
+            "java.lang.Class");
+
+    auto parameters_of = [&](jnipp::wrapping::jobject const& executable) {
+        std::vector<type_mapping> out;
+
+        for_each(executable[getParameterTypes](), [&](auto const& type) {
+            out.push_back(map_type(descriptor_of(unwrap(type[getName]()))));
+        });
+
+        return out;
+    };
+
+    std::vector<reflected_method> out;
+
+    for_each(clazz[getMethods](), [&](auto const& method) {
+        if(method[isBridge]() || method[isSynthetic]())
+            return;
+
+        out.push_back({
+            .name      = unwrap(method[getName]()),
+            .is_static = (method[getModifiers]() & modifier_static) != 0,
+            .is_constructor = false,
+            .result         = map_type(
+                descriptor_of(unwrap(method[getReturnType]()[getName]()))),
+            .parameters = parameters_of(method),
+        });
+    });
+
+    for_each(clazz[getConstructors](), [&](auto const& constructor) {
+        if(constructor[isSynthetic]())
+            return;
+
+        out.push_back({
+            .name           = "<init>",
+            .is_static      = true,
+            .is_constructor = true,
+            .result         = map_type("V"),
+            .parameters     = parameters_of(constructor),
+        });
+    });
+
+    return out;
+}
+
+std::string template_args(reflected_method const& method)
+{
+    std::string out = "jnipp::return_type::" + method.result.return_type;
+    for(auto const& parameter : method.parameters)
+        out += ", " + parameter.cpp_argument;
+    return out;
+}
+
+std::string method_object(reflected_method const& method)
+{
+    std::string out = "jnipp::wrapping::jmethod<" + template_args(method) +
+                      ">(jnipp::java::method(\"" + method.name + "\", \"" +
+                      method.signature() + "\"";
+
+    if(!method.result.result_class.empty())
+        out += ", jnipp::cache::descriptors().intern(\"" +
+               method.result.result_class + "\")";
+
+    return out + "))";
+}
+
+void emit_method(
+    std::ostream&            out,
+    std::string const&       proxy,
+    reflected_method const&  method,
+    std::set<std::string>&   emitted,
+    std::set<std::string> const& reserved)
+{
+    std::string parameters;
+    std::string arguments;
+
+    for(size_t i = 0; i < method.parameters.size(); i++)
+    {
+        if(i > 0)
+        {
+            parameters += ", ";
+            arguments += ", ";
+        }
+
+        parameters += method.parameters[i].cpp_argument + " a" +
+                      std::to_string(i);
+        arguments += "a" + std::to_string(i);
+    }
+
+    auto name = method.is_constructor ? std::string("create")
+                                      : identifier(method.name, reserved);
+
+    /* Java overloads may map to the same C++ parameters */
+    auto key = name + "(" + parameters + ")";
+    if(!emitted.insert(key).second)
+    {
+        out << "    /* " << method.name << method.signature()
+            << " collides with another overload */\n";
+        return;
+    }
+
+    if(method.is_constructor)
+    {
+        out << "    static " << proxy << " create(" << parameters << ")\n"
+            << "    {\n"
+            << "        static auto init = clazz().constructor(\n"
+            << "            " << method_object(method) << ");\n"
+            << "        return " << proxy
+            << "(jnipp::wrapping::jobject(*init(" << arguments << ")));\n"
+            << "    }\n";
+        return;
+    }
+
+    auto returns = method.result.cpp_result == "void" ? "" : "return ";
+
+    if(method.is_static)
+    {
+        out << "    static " << method.result.cpp_result << " " << name << "("
+            << parameters << ")\n"
+            << "    {\n"
+            << "        static auto method =\n"
+            << "            clazz()[" << method_object(method) << "];\n"
+            << "        " << returns << "method(" << arguments << ");\n"
+            << "    }\n";
+        return;
+    }
+
+    out << "    " << method.result.cpp_result << " " << name << "("
+        << parameters << ") const\n"
+        << "    {\n"
+        << "        static const jnipp::wrapping::bound_method<"
+        << template_args(method) << "> method(\n"
+        << "            clazz(), " << method_object(method) << ");\n"
+        << "        " << returns << "method(*this"
+        << (arguments.empty() ? "" : ", ") << arguments << ");\n"
+        << "    }\n";
+}
+
+void write_header(
+    std::string const&                   class_name,
+    std::vector<reflected_method> const& methods,
+    std::filesystem::path const&         directory,
+    std::string const&                   root_namespace)
+{
+    auto slashed   = jnipp::type_signature::slashify(class_name);
+    auto separator = slashed.rfind('/');
+    auto package   = separator == std::string::npos
+                         ? std::string()
+                         : slashed.substr(0, separator);
+    auto simple    = identifier(slashed.substr(separator + 1), {});
+
+    std::string namespace_name = root_namespace;
+    for(std::stringstream parts(package); !parts.eof();)
+    {
+        std::string part;
+        std::getline(parts, part, '/');
+        if(!part.empty())
+            namespace_name += "::" + identifier(part, {});
+    }
+
+    auto path = directory / (slashed + ".h");
+    std::filesystem::create_directories(path.parent_path());
+
+    std::ofstream out(path);
+
+    out << "/* Generated by jnipp-bindgen from " << class_name
+        << ", do not edit */\n"
+        << "#pragma once\n\n"
+        << "#include <jnipp.h>\n\n"
+        << "namespace " << namespace_name << " {\n\n"
+        << "struct " << simple << " : jnipp::wrapping::jobject\n"
+        << "{\n"
+        << "    explicit " << simple
+        << "(jnipp::wrapping::jobject const& instance)\n"
+        << "        : jobject(jnipp::java::object{clazz().clazz, "
+           "instance.object.instance})\n"
+        << "    {\n"
+        << "    }\n\n"
+        << "    static jnipp::wrapping::jclass const& clazz()\n"
+        << "    {\n"
+        << "        static const jnipp::wrapping::jclass clazz(\"" << slashed
+        << "\");\n"
+        << "        return clazz;\n"
+        << "    }\n";
+
+    /* Names which must not be hidden by a generated member */
+    std::set<std::string> const reserved = {
+        simple, "clazz", "object", "cast", "create"};
+    std::set<std::string> emitted;
+
+    for(auto const& method : methods)
+    {
+        out << "\n";
+        emit_method(out, simple, method, emitted, reserved);
+    }
+
+    out << "};\n\n"
+        << "} // namespace " << namespace_name << "\n";
+
+    std::printf("%s -> %s\n", class_name.c_str(), path.c_str());
+}
+
+void generate(
+    std::string const&           class_name,
+    std::filesystem::path const& directory,
+    std::string const&           root_namespace)
+{
+    static auto Class   = "java.lang.Class"_jclass;
+    static auto forName = "forName"_jmethod.ret("java.lang.Class")
+                              .arg<std::string>("java.lang.String");
+
+    write_header(
+        class_name,
+        reflect(Class[forName](class_name)),
+        directory,
+        root_namespace);
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    std::string              classpath = ".";
+    std::filesystem::path    directory = ".";
+    std::string              root      = "bindings";
+    std::vector<std::string> classes;
+
+    for(int i = 1; i < argc; i++)
+    {
+        if(std::strcmp(argv[i], "-cp") == 0 && i + 1 < argc)
+            classpath = argv[++i];
+        else if(std::strcmp(argv[i], "-o") == 0 && i + 1 < argc)
+            directory = argv[++i];
+        else if(std::strcmp(argv[i], "-n") == 0 && i + 1 < argc)
+            root = argv[++i];
+        else
+            classes.push_back(argv[i]);
+    }
+
+    if(classes.empty())
+    {
+        std::fprintf(
+            stderr,
+            "usage: %s [-cp classpath] [-o directory] [-n namespace] "
+            "class...\n",
+            argv[0]);
+        return 1;
+    }
+
+    JavaVM* jvm = nullptr;
+
+    auto classpath_option = "-Djava.class.path=" + classpath;
+
+    JavaVMInitArgs vm_args;
+    JavaVMOption   option;
+    option.optionString        = classpath_option.data();
+    vm_args.version            = JNI_VERSION_1_6;
+    vm_args.nOptions           = 1;
+    vm_args.options            = &option;
+    vm_args.ignoreUnrecognized = false;
+
+    if(JNI_CreateJavaVM(&jvm, reinterpret_cast<void**>(&globalEnv), &vm_args) !=
+       JNI_OK)
+    {
+        std::fprintf(stderr, "failed to start the JVM\n");
+        return 1;
+    }
+
+    int status = 0;
+
+    for(auto const& class_name : classes)
+    {
+        try
+        {
+            generate(class_name, directory, root);
+        } catch(std::exception const& e)
+        {
+            std::fprintf(stderr, "%s: %s\n", class_name.c_str(), e.what());
+            status = 1;
+        }
+    }
+
+    jvm->DestroyJavaVM();
+
+    return status;
+}
@@ -50,7 +50,7 @@ template<
     typename std::enable_if<std::is_same<T, jchar>::value>::type* = nullptr>
 inline std::string to_str()
 {
-    return "B";
+    return "C";
 }
 
 template<
@@ -223,6 +223,41 @@ inline std::string to_str(std::string const& c = {})
     throw std::runtime_error("invalid type");
 }
 
+/* Boxed types */
+
+template<typename T>
+/*!
+ * \brief Slashed class name of the box for a primitive type
+ * \return
+ */
+constexpr const char* boxed_class()
+{
+    if constexpr(std::is_same_v<T, jboolean>)
+        return "java/lang/Boolean";
+    else if constexpr(std::is_same_v<T, jbyte>)
+        return "java/lang/Byte";
+    else if constexpr(std::is_same_v<T, jchar>)
+        return "java/lang/Character";
+    else if constexpr(std::is_same_v<T, jshort>)
+        return "java/lang/Short";
+    else if constexpr(std::is_same_v<T, jint>)
+        return "java/lang/Integer";
+    else if constexpr(std::is_same_v<T, jlong>)
+        return "java/lang/Long";
+    else if constexpr(std::is_same_v<T, jfloat>)
+        return "java/lang/Float";
+    else if constexpr(std::is_same_v<T, jdouble>)
+        return "java/lang/Double";
+}
+
+template<
+    typename T,
+    typename std::enable_if<java::is_boxed<T>::value>::type* = nullptr>
+inline std::string to_str()
+{
+    return std::string("L") + boxed_class<decltype(T::value)>() + ";";
+}
+
 /* Exceptional types */
 
 template<
@@ -1,8 +1,13 @@
 #pragma once
 
 #include "arrays.h"
+#include "checks.h"
 #include "jni_types.h"
 #include "object_test.h"
+#include "utf.h"
+
+#include <memory_resource>
+#include <string>
 
 namespace jnipp::java {
 
@@ -22,6 +27,23 @@ struct type_unwrapper
     java::value value;
 };
 
+namespace detail {
+
+template<typename String>
+inline String unwrap_string(java::object const& value, String out)
+{
+    if constexpr(checks::types)
+        objects::verify_instance_of(value, "java/lang/String");
+
+    jstring str_obj = reinterpret_cast<jstring>(static_cast<::jobject>(value));
+
+    utf::from_java(str_obj, out);
+
+    return out;
+}
+
+} // namespace detail
+
 template<>
 struct type_unwrapper<std::string>
 {
@@ -32,22 +54,34 @@ struct type_unwrapper<std::string>
 
     operator std::string() const
     {
-        objects::verify_instance_of(value, "java/lang/String");
-
-        jstring str_obj =
-            reinterpret_cast<jstring>(static_cast<::jobject>(value));
+        return detail::unwrap_string(value, std::string());
+    }
 
-        auto        chars = GetJNI()->GetStringUTFChars(str_obj, nullptr);
-        std::string out;
-        if(chars)
-            out = chars;
+    java::object value;
+};
 
-        GetJNI()->ReleaseStringUTFChars(str_obj, chars);
+template<>
+/*!
+ * \brief Unwraps into a string allocated from a memory resource, eg. a
+ * std::pmr::monotonic_buffer_resource that is released all at once
+ */
+struct type_unwrapper<std::pmr::string>
+{
+    type_unwrapper(
+        java::object               value,
+        std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+        : value(value)
+        , resource(resource)
+    {
+    }
 
-        return out;
+    operator std::pmr::string() const
+    {
+        return detail::unwrap_string(value, std::pmr::string(resource));
     }
 
-    java::object value;
+    java::object               value;
+    std::pmr::memory_resource* resource;
 };
 
 template<return_type T>
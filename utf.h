@@ -0,0 +1,362 @@
+#pragma once
+
+#include "jni_types.h"
+
+#include <cstring>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+/* Conversion between Java's UTF-16 strings and real UTF-8, as opposed to the
+ * modified UTF-8 of NewStringUTF/GetStringUTFChars. Runs of ASCII are
+ * converted with SSE2 or AVX2 when available, everything else goes through
+ * the scalar path. Unpaired surrogates and invalid UTF-8 become U+FFFD. */
+
+namespace jnipp::invocation::call {
+
+void check_exception();
+
+} // namespace jnipp::invocation::call
+
+namespace jnipp::utf {
+
+namespace detail {
+
+/*!
+ * \brief Convert the leading ASCII characters of in, 8 or 16 at a time
+ * \return number of characters converted
+ */
+inline size_t ascii_utf16_to_utf8(const jchar* in, size_t length, char* out)
+{
+    size_t i = 0;
+
+#if defined(__AVX2__)
+    auto const non_ascii = _mm256_set1_epi16(static_cast<short>(0xFF80));
+
+    for(; i + 16 <= length; i += 16)
+    {
+        auto chars =
+            _mm256_loadu_si256(reinterpret_cast<__m256i const*>(in + i));
+
+        if(!_mm256_testz_si256(chars, non_ascii))
+            break;
+
+        auto packed = _mm_packus_epi16(
+            _mm256_castsi256_si128(chars), _mm256_extracti128_si256(chars, 1));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), packed);
+    }
+#endif
+
+#if defined(__SSE2__)
+    auto const non_ascii_sse = _mm_set1_epi16(static_cast<short>(0xFF80));
+    auto const zero          = _mm_setzero_si128();
+
+    for(; i + 8 <= length; i += 8)
+    {
+        auto chars = _mm_loadu_si128(reinterpret_cast<__m128i const*>(in + i));
+        auto high  = _mm_and_si128(chars, non_ascii_sse);
+
+        if(_mm_movemask_epi8(_mm_cmpeq_epi16(high, zero)) != 0xFFFF)
+            break;
+
+        _mm_storel_epi64(
+            reinterpret_cast<__m128i*>(out + i), _mm_packus_epi16(chars, zero));
+    }
+#endif
+
+    return i;
+}
+
+/*!
+ * \brief Convert the leading ASCII bytes of in, 16 or 32 at a time
+ * \return number of bytes converted
+ */
+inline size_t ascii_utf8_to_utf16(const char* in, size_t length, jchar* out)
+{
+    size_t i = 0;
+
+#if defined(__AVX2__)
+    for(; i + 32 <= length; i += 32)
+    {
+        auto bytes =
+            _mm256_loadu_si256(reinterpret_cast<__m256i const*>(in + i));
+
+        if(_mm256_movemask_epi8(bytes) != 0)
+            break;
+
+        _mm256_storeu_si256(
+            reinterpret_cast<__m256i*>(out + i),
+            _mm256_cvtepu8_epi16(_mm256_castsi256_si128(bytes)));
+        _mm256_storeu_si256(
+            reinterpret_cast<__m256i*>(out + i + 16),
+            _mm256_cvtepu8_epi16(_mm256_extracti128_si256(bytes, 1)));
+    }
+#endif
+
+#if defined(__SSE2__)
+    auto const zero = _mm_setzero_si128();
+
+    for(; i + 16 <= length; i += 16)
+    {
+        auto bytes = _mm_loadu_si128(reinterpret_cast<__m128i const*>(in + i));
+
+        if(_mm_movemask_epi8(bytes) != 0)
+            break;
+
+        _mm_storeu_si128(
+            reinterpret_cast<__m128i*>(out + i),
+            _mm_unpacklo_epi8(bytes, zero));
+        _mm_storeu_si128(
+            reinterpret_cast<__m128i*>(out + i + 8),
+            _mm_unpackhi_epi8(bytes, zero));
+    }
+#endif
+
+    return i;
+}
+
+} // namespace detail
+
+/*!
+ * \brief Largest number of UTF-8 bytes that length UTF-16 units can become
+ */
+constexpr size_t max_utf8_length(size_t length)
+{
+    return length * 3;
+}
+
+/*!
+ * \brief Convert UTF-16 to UTF-8
+ * \param in
+ * \param length number of UTF-16 units in in
+ * \param out buffer of at least max_utf8_length(length) bytes
+ * \return number of bytes written
+ */
+inline size_t utf16_to_utf8(const jchar* in, size_t length, char* out)
+{
+    size_t i = 0;
+    size_t o = 0;
+
+    while(i < length)
+    {
+        if(in[i] < 0x80)
+        {
+            auto n = detail::ascii_utf16_to_utf8(in + i, length - i, out + o);
+
+            /* Too short for a vector, take a single character */
+            if(n == 0)
+                out[o + n++] = static_cast<char>(in[i]);
+
+            i += n;
+            o += n;
+            continue;
+        }
+
+        char32_t c = in[i++];
+
+        if(c >= 0xD800 && c <= 0xDBFF && i < length && in[i] >= 0xDC00 &&
+           in[i] <= 0xDFFF)
+            c = 0x10000 + ((c - 0xD800) << 10) + (in[i++] - 0xDC00);
+        else if(c >= 0xD800 && c <= 0xDFFF)
+            c = 0xFFFD;
+
+        if(c < 0x800)
+        {
+            out[o++] = static_cast<char>(0xC0 | (c >> 6));
+            out[o++] = static_cast<char>(0x80 | (c & 0x3F));
+        } else if(c < 0x10000)
+        {
+            out[o++] = static_cast<char>(0xE0 | (c >> 12));
+            out[o++] = static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+            out[o++] = static_cast<char>(0x80 | (c & 0x3F));
+        } else
+        {
+            out[o++] = static_cast<char>(0xF0 | (c >> 18));
+            out[o++] = static_cast<char>(0x80 | ((c >> 12) & 0x3F));
+            out[o++] = static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+            out[o++] = static_cast<char>(0x80 | (c & 0x3F));
+        }
+    }
+
+    return o;
+}
+
+/*!
+ * \brief Convert UTF-8 to UTF-16
+ * \param in
+ * \param length number of bytes in in
+ * \param out buffer of at least length UTF-16 units
+ * \return number of UTF-16 units written
+ */
+inline size_t utf8_to_utf16(const char* in, size_t length, jchar* out)
+{
+    auto   bytes = reinterpret_cast<const unsigned char*>(in);
+    size_t i     = 0;
+    size_t o     = 0;
+
+    auto continuation = [&](size_t at) {
+        return at < length && (bytes[at] & 0xC0) == 0x80;
+    };
+
+    while(i < length)
+    {
+        if(bytes[i] < 0x80)
+        {
+            auto n = detail::ascii_utf8_to_utf16(in + i, length - i, out + o);
+
+            if(n == 0)
+                out[o + n++] = bytes[i];
+
+            i += n;
+            o += n;
+            continue;
+        }
+
+        char32_t c     = 0xFFFD;
+        size_t   count = 1;
+
+        if((bytes[i] & 0xE0) == 0xC0 && continuation(i + 1))
+        {
+            auto cp = ((bytes[i] & 0x1Fu) << 6) | (bytes[i + 1] & 0x3Fu);
+            if(cp >= 0x80)
+            {
+                c     = cp;
+                count = 2;
+            }
+        } else if(
+            (bytes[i] & 0xF0) == 0xE0 && continuation(i + 1) &&
+            continuation(i + 2))
+        {
+            auto cp = ((bytes[i] & 0x0Fu) << 12) |
+                      ((bytes[i + 1] & 0x3Fu) << 6) | (bytes[i + 2] & 0x3Fu);
+            if(cp >= 0x800 && (cp < 0xD800 || cp > 0xDFFF))
+            {
+                c     = cp;
+                count = 3;
+            }
+        } else if(
+            (bytes[i] & 0xF8) == 0xF0 && continuation(i + 1) &&
+            continuation(i + 2) && continuation(i + 3))
+        {
+            auto cp = ((bytes[i] & 0x07u) << 18) |
+                      ((bytes[i + 1] & 0x3Fu) << 12) |
+                      ((bytes[i + 2] & 0x3Fu) << 6) | (bytes[i + 3] & 0x3Fu);
+            if(cp >= 0x10000 && cp <= 0x10FFFF)
+            {
+                c     = cp;
+                count = 4;
+            }
+        }
+
+        i += count;
+
+        if(c >= 0x10000)
+        {
+            c -= 0x10000;
+            out[o++] = static_cast<jchar>(0xD800 + (c >> 10));
+            out[o++] = static_cast<jchar>(0xDC00 + (c & 0x3FF));
+        } else
+            out[o++] = static_cast<jchar>(c);
+    }
+
+    return o;
+}
+
+template<typename String>
+/*!
+ * \brief Append UTF-16 to a std::string-like container as UTF-8
+ * \param out
+ * \param in
+ * \param length
+ */
+inline void append_utf8(String& out, const jchar* in, size_t length)
+{
+    auto offset = out.size();
+    out.resize(offset + max_utf8_length(length));
+    out.resize(offset + utf16_to_utf8(in, length, out.data() + offset));
+}
+
+/*!
+ * \brief Read a Java string as UTF-8 into a buffer
+ * \param str
+ * \param length length of str in UTF-16 code units
+ * \param out buffer of at least max_utf8_length(length) bytes
+ * \param env
+ * \return number of bytes written
+ */
+inline size_t from_java(
+    ::jstring str, size_t length, char* out, JNIEnv* env = GetJNI())
+{
+    /* Short strings are copied out, which avoids pinning them */
+    if(length <= 64)
+    {
+        jchar chars[64];
+        env->GetStringRegion(str, 0, static_cast<jsize>(length), chars);
+        return utf16_to_utf8(chars, length, out);
+    }
+
+    /* No JNI calls are allowed inside the critical section, so the buffer
+     * has to be large enough up front */
+    auto chars = env->GetStringCritical(str, nullptr);
+
+    if(!chars)
+    {
+        invocation::call::check_exception();
+        throw std::runtime_error("failed to get string characters");
+    }
+
+    auto written = utf16_to_utf8(chars, length, out);
+    env->ReleaseStringCritical(str, chars);
+
+    return written;
+}
+
+/*!
+ * \brief Read a Java string as UTF-8
+ * \param str
+ * \param out string to append to
+ */
+template<typename String>
+inline void from_java(::jstring str, String& out)
+{
+    auto env    = GetJNI();
+    auto length = static_cast<size_t>(env->GetStringLength(str));
+    auto offset = out.size();
+
+    out.resize(offset + max_utf8_length(length));
+
+    try
+    {
+        out.resize(offset + from_java(str, length, out.data() + offset, env));
+    } catch(...)
+    {
+        out.resize(offset);
+        throw;
+    }
+}
+
+/*!
+ * \brief Create a Java string from UTF-8
+ * \param value
+ * \return a local reference to the string
+ */
+inline ::jstring to_java(std::string_view value)
+{
+    jchar small[64];
+
+    if(value.size() <= 64)
+    {
+        auto length = utf8_to_utf16(value.data(), value.size(), small);
+        return GetJNI()->NewString(small, static_cast<jsize>(length));
+    }
+
+    std::vector<jchar> chars(value.size());
+    auto length = utf8_to_utf16(value.data(), value.size(), chars.data());
+    return GetJNI()->NewString(chars.data(), static_cast<jsize>(length));
+}
+
+} // namespace jnipp::utf
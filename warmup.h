@@ -0,0 +1,222 @@
+#pragma once
+
+#include "cache.h"
+#include "field_access.h"
+#include "method_calls.h"
+#include "type_signatures.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+namespace jnipp {
+
+/*!
+ * \brief The set of classes and members a module uses, declared in one place
+ * so that they can be resolved into the caches at startup with warmup()
+ */
+struct warmup_manifest
+{
+    enum class kind
+    {
+        class_,
+        method_,
+        static_method_,
+        field_,
+        static_field_,
+    };
+
+    struct entry
+    {
+        kind        type;
+        std::string class_name;
+        std::string name;
+        std::string signature;
+
+        std::string describe() const
+        {
+            if(type == kind::class_)
+                return class_name;
+            return class_name + "." + name + signature;
+        }
+    };
+
+    warmup_manifest& clazz(std::string const& name)
+    {
+        entries.push_back({
+            kind::class_,
+            type_signature::slashify(name),
+            {},
+            {},
+        });
+        return *this;
+    }
+
+    template<return_type RType, typename... Args>
+    warmup_manifest& method(
+        std::string const& clazz, wrapping::jmethod<RType, Args...> const& m)
+    {
+        return member(kind::method_, clazz, m.name(), m.signature());
+    }
+
+    template<return_type RType, typename... Args>
+    warmup_manifest& static_method(
+        std::string const& clazz, wrapping::jmethod<RType, Args...> const& m)
+    {
+        return member(kind::static_method_, clazz, m.name(), m.signature());
+    }
+
+    template<return_type T>
+    warmup_manifest& field(
+        std::string const& clazz, wrapping::jfield<T> const& f)
+    {
+        return member(kind::field_, clazz, f.name(), f.signature());
+    }
+
+    template<return_type T>
+    warmup_manifest& static_field(
+        std::string const& clazz, wrapping::jfield<T> const& f)
+    {
+        return member(kind::static_field_, clazz, f.name(), f.signature());
+    }
+
+    std::vector<entry> entries;
+
+  private:
+    warmup_manifest& member(
+        kind               type,
+        std::string const& clazz,
+        const char*        name,
+        const char*        signature)
+    {
+        entries.push_back({
+            type,
+            type_signature::slashify(clazz),
+            name,
+            signature,
+        });
+        return *this;
+    }
+};
+
+struct warmup_report
+{
+    std::string              entry;
+    std::chrono::nanoseconds duration;
+    bool                     resolved;
+};
+
+namespace detail {
+
+inline bool warmup_entry(warmup_manifest::entry const& entry, JNIEnv* env)
+{
+    using kind = warmup_manifest::kind;
+
+    auto clazz = cache::classes().resolve(entry.class_name, env);
+
+    if(clazz && entry.type != kind::class_)
+    {
+        auto is_static =
+            entry.type == kind::static_method_ ||
+            entry.type == kind::static_field_;
+        auto name      = entry.name.c_str();
+        auto signature = entry.signature.c_str();
+
+        if(entry.type == kind::method_ || entry.type == kind::static_method_)
+            cache::method_id(clazz, name, signature, is_static, env);
+        else
+            cache::field_id(clazz, name, signature, is_static, env);
+    }
+
+    if(env->ExceptionCheck() == JNI_TRUE)
+    {
+        env->ExceptionClear();
+        return false;
+    }
+
+    return true;
+}
+
+inline warmup_report warmup_timed(
+    warmup_manifest::entry const& entry, JNIEnv* env)
+{
+    auto start = std::chrono::steady_clock::now();
+    auto ok    = warmup_entry(entry, env);
+
+    return {
+        entry.describe(),
+        std::chrono::steady_clock::now() - start,
+        ok,
+    };
+}
+
+inline void warmup_range(
+    warmup_manifest const&      manifest,
+    std::vector<warmup_report>& report,
+    std::atomic_size_t&         next,
+    JNIEnv*                     env)
+{
+    for(auto i = next++; i < manifest.entries.size(); i = next++)
+        report[i] = warmup_timed(manifest.entries[i], env);
+}
+
+} // namespace detail
+
+/*!
+ * \brief Resolve all classes and members of a manifest into the caches.
+ * Failed lookups are cleared and reported instead of thrown.
+ * \param manifest
+ * \param threads number of threads to attach to the JVM and resolve entries
+ * on, with 0 resolving everything on the calling thread. Note that FindClass
+ * on natively attached threads only sees the system class loader.
+ * \return time spent on each entry, in manifest order
+ */
+inline std::vector<warmup_report> warmup(
+    warmup_manifest const& manifest, unsigned threads = 0)
+{
+    std::vector<warmup_report> report(manifest.entries.size());
+    std::atomic_size_t         next = 0;
+
+    if(threads == 0)
+    {
+        detail::warmup_range(manifest, report, next, GetJNI());
+        return report;
+    }
+
+    JavaVM* vm = nullptr;
+    GetJNI()->GetJavaVM(&vm);
+
+    std::vector<std::thread> workers;
+
+    for(unsigned i = 0; i < threads; i++)
+        workers.emplace_back([&]() {
+            JNIEnv* env = nullptr;
+
+#if defined(__ANDROID__)
+            auto status = vm->AttachCurrentThread(&env, nullptr);
+#else
+            auto status = vm->AttachCurrentThread(
+                reinterpret_cast<void**>(&env), nullptr);
+#endif
+
+            if(status != JNI_OK)
+                return;
+
+            detail::warmup_range(manifest, report, next, env);
+
+            vm->DetachCurrentThread();
+        });
+
+    for(auto& worker : workers)
+        worker.join();
+
+    /* Pick up whatever could not be done on the workers */
+    for(size_t i = 0; i < report.size(); i++)
+        if(report[i].entry.empty())
+            report[i] = detail::warmup_timed(manifest.entries[i], GetJNI());
+
+    return report;
+}
+
+} // namespace jnipp
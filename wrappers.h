@@ -1,6 +1,7 @@
 #pragma once
 
 #include "jni_types.h"
+#include "utf.h"
 
 namespace jnipp::java {
 
@@ -27,9 +28,8 @@ struct type_wrapper<std::string>
 
     operator jvalue() const
     {
-        jvalue  out;
-        jstring val = GetJNI()->NewStringUTF(value.c_str());
-        out.l       = val;
+        jvalue out;
+        out.l = utf::to_java(value);
         return out;
     }
 